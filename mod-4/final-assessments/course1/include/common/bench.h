@@ -0,0 +1,205 @@
+/******************************************************************************
+ * Copyright (C) 2025 by Michael Torres
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Michael Torres is not liable for any misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file bench.h
+ * @brief Benchmarks for the statistics functions.
+ *
+ * The benchmarks are built into the executable when BENCH is defined, and are
+ * run by main in place of the course1 tests. On HOST times are reported in
+ * microseconds; on the MSP432 they are reported in core clock cycles.
+ *
+ * @author Michael Torres
+ * @date 10/18/26
+ *
+ */
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <stdint.h>
+
+#if defined(HOST)
+/* Largest array size benchmarked; sizes grow by 10x from BENCH_MIN_LEN. */
+#define BENCH_MAX_LEN (100000000u)
+/* Quick sort is too slow to be worth timing above this size. */
+#define BENCH_QUICKSORT_MAX_LEN (10000000u)
+#else
+#define BENCH_MAX_LEN (1000u)
+#define BENCH_QUICKSORT_MAX_LEN (1000u)
+#endif
+#define BENCH_MIN_LEN (1000u)
+/* Data-sets, and samples in each, for bench_batch. */
+#if defined(HOST)
+#define BENCH_BATCH_COUNT (10000u)
+#else
+#define BENCH_BATCH_COUNT (32u)
+#endif
+#define BENCH_BATCH_LEN (40u)
+/* Array sizes searched by bench_search, growing by 10x, and the lookups timed
+ * at each; define BENCH_SEARCH_MAX_LEN as 1000000000 to search 1B samples. */
+#if defined(HOST)
+#define BENCH_SEARCH_MIN_LEN (1000000u)
+#ifndef BENCH_SEARCH_MAX_LEN
+#define BENCH_SEARCH_MAX_LEN (100000000u)
+#endif
+#define BENCH_SEARCH_QUERIES (1000000u)
+#else
+#define BENCH_SEARCH_MIN_LEN (1000u)
+#define BENCH_SEARCH_MAX_LEN (1000u)
+#define BENCH_SEARCH_QUERIES (1000u)
+#endif
+/* Stream length for bench_hll, and the largest number of distinct values in
+ * it; the distinct counts grow by 10x from BENCH_MIN_LEN. */
+#if defined(HOST)
+#define BENCH_HLL_LEN (10000000u)
+#define BENCH_HLL_MAX_DISTINCT (10000000u)
+#else
+#define BENCH_HLL_LEN (1000u)
+#define BENCH_HLL_MAX_DISTINCT (1000u)
+#endif
+/* Frames timed by bench_outliers at each frame length, which grow by 4x from
+ * BENCH_OUTLIER_MIN_LEN. */
+#if defined(HOST)
+#define BENCH_OUTLIER_FRAMES (10000u)
+#else
+#define BENCH_OUTLIER_FRAMES (8u)
+#endif
+#define BENCH_OUTLIER_MIN_LEN (64u)
+#define BENCH_OUTLIER_MAX_LEN (1024u)
+/* Stereo frames split by bench_columns, and the statistics queries made of
+ * each channel. */
+#if defined(HOST)
+#define BENCH_COLUMNS_FRAMES (4000000u)
+#else
+#define BENCH_COLUMNS_FRAMES (256u)
+#endif
+#define BENCH_COLUMNS_QUERIES (4u)
+/* Samples compressed by bench_packed, and the random ranges queried. */
+#if defined(HOST)
+#define BENCH_PACKED_LEN (10000000u)
+#define BENCH_PACKED_QUERIES (1000u)
+#else
+#define BENCH_PACKED_LEN (4096u)
+#define BENCH_PACKED_QUERIES (8u)
+#endif
+/* Largest array bench_mode finds the mode of; sizes grow by 10x from
+ * BENCH_MIN_LEN. */
+#if defined(HOST)
+#define BENCH_MODE_MAX_LEN (10000000u)
+#else
+#define BENCH_MODE_MAX_LEN (1000u)
+#endif
+
+/**
+ * @brief Run all of the benchmarks.
+ *
+ * @return void
+ */
+void bench(void);
+
+/**
+ * @brief Benchmark radix_sort against quicksort.
+ *
+ * Sorts arrays of uniformly random 16-bit and 32-bit samples, from
+ * BENCH_MIN_LEN up to BENCH_MAX_LEN in steps of 10x, with each sort and prints
+ * one line per size.
+ *
+ * @return void
+ */
+void bench_sort(void);
+
+/**
+ * @brief Benchmark find_statistics_batch against find_statistics.
+ *
+ * Finds the statistics of BENCH_BATCH_COUNT random data-sets of
+ * BENCH_BATCH_LEN samples, once with a find_statistics call per data-set and
+ * once with a single find_statistics_batch call, and prints both times.
+ *
+ * @return void
+ */
+void bench_batch(void);
+
+/**
+ * @brief Benchmark the searches of search.h against a plain binary search.
+ *
+ * Looks up BENCH_SEARCH_QUERIES random values in sorted arrays of 32-bit
+ * samples, from BENCH_SEARCH_MIN_LEN up to BENCH_SEARCH_MAX_LEN in steps of
+ * 10x, with a branching binary search, lower_bound and eytzinger_lower_bound,
+ * and prints one line per size. Once an array is much larger than the cache
+ * the time is mostly cache misses, so the differences show how many each
+ * search avoids.
+ *
+ * @return void
+ */
+void bench_search(void);
+
+/**
+ * @brief Benchmark the HyperLogLog sketch against counting after a sort.
+ *
+ * Counts the distinct values of a stream of BENCH_HLL_LEN 32-bit IDs, with
+ * from BENCH_MIN_LEN up to BENCH_HLL_MAX_DISTINCT distinct values in steps of
+ * 10x, once with a sketch of HLL_DEFAULT_PRECISION and once exactly with
+ * radix_sort_u32 and a scan. Prints one line per count with both times, the
+ * estimate and its error in percent.
+ *
+ * @return void
+ */
+void bench_hll(void);
+
+/**
+ * @brief Benchmark the outlier flagging of flag_outliers_mad and _iqr.
+ *
+ * Flags BENCH_OUTLIER_FRAMES frames of random 16-bit samples, with a few
+ * spikes in each, for frame lengths from BENCH_OUTLIER_MIN_LEN up to
+ * BENCH_OUTLIER_MAX_LEN in steps of 4x, and prints one line per length with
+ * the time per frame of each method.
+ *
+ * @return void
+ */
+void bench_outliers(void);
+
+/**
+ * @brief Benchmark a columns_t table against copying channels out.
+ *
+ * Finds the mean of both channels of BENCH_COLUMNS_FRAMES interleaved frames
+ * of 16-bit samples BENCH_COLUMNS_QUERIES times, once copying each channel
+ * out of the frames for every query and once splitting the frames into a
+ * table first and reading its columns in place. Prints the time of the
+ * copies, of the split and of the queries on the columns.
+ *
+ * @return void
+ */
+void bench_columns(void);
+
+/**
+ * @brief Benchmark range statistics on packed samples against raw ones.
+ *
+ * Compresses BENCH_PACKED_LEN slowly varying 8-bit samples, a random walk of
+ * steps from -2 to 2, and finds the maximum, minimum and mean of
+ * BENCH_PACKED_QUERIES random ranges of them, once with describe on the raw
+ * samples and once with packed_maximum, packed_minimum and packed_mean.
+ * Prints the packed size as a percentage of the raw size and both times.
+ *
+ * @return void
+ */
+void bench_packed(void);
+
+/**
+ * @brief Benchmark find_mode against sorting and scanning for runs.
+ *
+ * Finds the mode of arrays of 16-bit samples drawn from 4096 values, from
+ * BENCH_MIN_LEN up to BENCH_MODE_MAX_LEN in steps of 10x, once with
+ * sort_array and a scan for the longest run, once with find_mode and once
+ * with a space-saving sketch, and prints one line per size.
+ *
+ * @return void
+ */
+void bench_mode(void);
+
+#endif /* __BENCH_H__ */
@@ -0,0 +1,143 @@
+/******************************************************************************
+ * Copyright (C) 2025 by Michael Torres
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Michael Torres is not liable for any misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file columns.h
+ * @brief Multi-channel samples stored one channel after another.
+ *
+ * Devices deliver several channels interleaved, one frame of a sample from
+ * each channel at a time, while the statistics functions want each channel as
+ * one array. Copying a channel out before every call reads the whole
+ * interleaved buffer each time. A columns_t instead splits the frames into
+ * one array per channel once, as they arrive, and then hands out the arrays
+ * themselves: any function of stats.h can be given a column and the table's
+ * length, or a dataset_t can be wrapped around it, without a copy.
+ *
+ * The columns share one reservation, and each starts on a COLUMNS_ALIGN byte
+ * boundary so that no two columns share a cache line.
+ *
+ * @author Michael Torres
+ * @date 10/18/26
+ *
+ */
+#ifndef __COLUMNS_H__
+#define __COLUMNS_H__
+
+#include "dataset.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/* Most channels a table can hold. */
+#ifndef COLUMNS_MAX_CHANNELS
+#if defined(HOST)
+#define COLUMNS_MAX_CHANNELS (16u)
+#else
+#define COLUMNS_MAX_CHANNELS (8u)
+#endif
+#endif
+/* Alignment of each column, in bytes: a cache line on HOST, a word on the
+ * MSP432, which has no data cache. */
+#if defined(HOST)
+#define COLUMNS_ALIGN (64u)
+#else
+#define COLUMNS_ALIGN (4u)
+#endif
+
+/**
+ * @brief A table of channels, each stored as its own array.
+ *
+ * Column c holds samples of the type given by type, from columns[c][0] to
+ * columns[c][len - 1], with room for capacity of them.
+ */
+typedef struct {
+  uint8_t *storage;
+  uint8_t *columns[COLUMNS_MAX_CHANNELS];
+  size_t len;
+  size_t capacity;
+  dataset_type_t type;
+  uint8_t channels;
+} columns_t;
+
+/**
+ * @brief Reserve an empty table.
+ *
+ * @param table A pointer to the table.
+ * @param type The type of the samples of every channel.
+ * @param channels The number of channels, from 1 to COLUMNS_MAX_CHANNELS.
+ * @param capacity The number of frames the table can hold; must be non-zero.
+ *
+ * @return 0 on success, or -1 if the channels are out of range or the
+ *         columns could not be reserved.
+ */
+int columns_init(columns_t *const table, const dataset_type_t type,
+                 const unsigned int channels, const size_t capacity);
+
+/**
+ * @brief Free the columns of a table.
+ *
+ * @param table A pointer to the table; it must be reserved again before use.
+ */
+void columns_free(columns_t *const table);
+
+/**
+ * @brief Empty a table, keeping its columns for new frames.
+ *
+ * @param table A pointer to the table.
+ */
+void columns_clear(columns_t *const table);
+
+/**
+ * @brief Append interleaved frames to a table.
+ *
+ * Each frame is one sample of every channel in turn. The frames are split
+ * into the columns a block at a time, so that the block read is still in the
+ * cache while each column's part is written. Two channels of 16-bit samples,
+ * the usual stereo layout, are split eight frames at a time with SSE2 on
+ * HOST.
+ *
+ * @param table A pointer to the table.
+ * @param interleaved A read-only pointer to the frames, aligned for the type.
+ * @param frames The number of frames.
+ *
+ * @return The number of frames appended; fewer than frames once the table is
+ *         full.
+ */
+size_t columns_ingest(columns_t *const table, const void *const interleaved,
+                      const size_t frames);
+
+/**
+ * @brief Get the samples of one channel.
+ *
+ * The pointer is into the table, not a copy, so it can be passed straight to
+ * the functions of stats.h with the table's len; sorting it reorders that
+ * channel only, after which its samples no longer line up with the other
+ * channels' by frame. It stays valid until the table is freed.
+ *
+ * @param table A read-only pointer to the table.
+ * @param channel The channel; below the table's channels.
+ *
+ * @return A pointer to the column, aligned to COLUMNS_ALIGN.
+ */
+void *columns_column(const columns_t *const table,
+                     const unsigned int channel);
+
+/**
+ * @brief Wrap a data-set handle around one channel of a table.
+ *
+ * The handle points into the table, as columns_column does, and holds the
+ * frames the table has now; ingest more and it must be wrapped again.
+ *
+ * @param table A read-only pointer to a table holding at least one frame.
+ * @param channel The channel; below the table's channels.
+ * @param view A pointer to the handle.
+ */
+void columns_view(const columns_t *const table, const unsigned int channel,
+                  dataset_t *const view);
+
+#endif /* __COLUMNS_H__ */
@@ -33,7 +33,23 @@
 #define TEST_MEMMOVE_LENGTH (16)
 #define TEST_ERROR (1)
 #define TEST_NO_ERROR (0)
-#define TESTCOUNT (8)
+#define TEST_VARIANCE_LENGTH (33)
+/* Samples, shuffling stride and allowed rank error of test_quantiles; 2% of
+ * the count, against the sketch's 1.33% bound. */
+#define TEST_QUANTILE_COUNT (10000)
+#define TEST_QUANTILE_STEP (7919)
+#define TEST_QUANTILE_ERROR (200)
+#define TEST_WINDOW_LENGTH (6)
+#define TEST_WINDOW_SAMPLES (40)
+/* Squared bounds of test_hll: a relative error of 1% for a sparse sketch,
+ * and four standard errors, 1.04 / sqrt(registers) each, for a dense one. */
+#define TEST_HLL_SPARSE_ERROR (0.0001)
+#define TEST_HLL_SIGMAS (4.16 * 4.16)
+#define TEST_PACKED_LENGTH (400)
+#define TEST_FREQUENT_DISTINCT (300)
+#define TEST_FREQUENT_LENGTH (900)
+#define TEST_FREQUENT_TOP (8)
+#define TESTCOUNT (15)
 
 /**
  * @brief function to run course1 materials
@@ -131,4 +147,84 @@ int8_t test_memset();
  */
 int8_t test_reverse();
 
+/**
+ * @brief function to test the 16-bit variance functionality
+ *
+ * This function calls find_variance_s16 on an odd number of samples that
+ * reach both ends of the 16-bit range, and checks it against the variance
+ * worked out one sample at a time. On the MSP432 that compares the
+ * dual multiply-accumulate path with plain integer arithmetic.
+ *
+ * @return void
+ */
+int8_t test_variance();
+
+/**
+ * @brief function to test the selection functionality
+ *
+ * This function calls select_kth for every index of a set with repeated
+ * values, and find_median_select on an even and an odd length, and checks
+ * them against sort_array and find_median.
+ *
+ * @return void
+ */
+int8_t test_select();
+
+/**
+ * @brief function to test the quantile sketch functionality
+ *
+ * This function feeds a shuffled run of distinct values through two quantile
+ * sketches, merges them, and checks that the minimum and maximum are exact
+ * and that every decile is within TEST_QUANTILE_ERROR ranks of the truth.
+ *
+ * @return void
+ */
+int8_t test_quantiles();
+
+/**
+ * @brief function to test the sliding window functionality
+ *
+ * This function pushes a stream with repeated values through a sliding
+ * window and, after every sample, checks its median, mean, maximum and
+ * minimum against the sorted samples the window should hold, before and
+ * after it starts evicting them.
+ *
+ * @return void
+ */
+int8_t test_window();
+
+/**
+ * @brief function to test the distinct count functionality
+ *
+ * This function counts a small stream, which a HyperLogLog sketch keeps
+ * sparse, and a large one with every value repeated, which switches it to its
+ * registers, and then merges the large sketch into the small one. Each
+ * estimate is checked against the true number of distinct values.
+ *
+ * @return void
+ */
+int8_t test_hll();
+
+/**
+ * @brief function to test the compressed sample functionality
+ *
+ * This function compresses a set with a constant block and a jump, checks
+ * that it decompresses unchanged, and checks the maximum, minimum and mean
+ * of ranges that start and end inside blocks against the uncompressed set.
+ *
+ * @return void
+ */
+int8_t test_packed();
+
+/**
+ * @brief function to test the most frequent value functionality
+ *
+ * This function counts a set in which many values tie, as 8-bit and 16-bit
+ * samples, and checks that find_mode and top_frequent pick the largest value
+ * among ties and report exact counts against a brute-force count.
+ *
+ * @return void
+ */
+int8_t test_frequent();
+
 #endif /* __COURSE1_H__ */
@@ -0,0 +1,202 @@
+/******************************************************************************
+ * Copyright (C) 2025 by Michael Torres
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Michael Torres is not liable for any misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file dataset.h
+ * @brief A handle to a data-set that remembers what is known about it.
+ *
+ * find_median, find_maximum and find_minimum need data that has been through
+ * sort_array, which leads callers to sort again just in case. A dataset_t
+ * wraps a caller's array with its length, sample type, the order it is known
+ * to be in and the statistics found so far. Sorting data that is known to be
+ * sorted does nothing, and a statistic is found once and then returned from
+ * the cache until the data is changed through the handle.
+ *
+ * @author Michael Torres
+ * @date 10/18/26
+ *
+ */
+#ifndef __DATASET_H__
+#define __DATASET_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief The sample type of a data-set.
+ */
+typedef enum {
+  DATASET_U8,
+  DATASET_U16,
+  DATASET_S16,
+  DATASET_U32,
+  DATASET_S32,
+  DATASET_F32
+} dataset_type_t;
+
+/**
+ * @brief The order a data-set is known to be in.
+ */
+typedef enum {
+  DATASET_UNSORTED,
+  /* Largest to smallest, as sort_array leaves it. */
+  DATASET_DESCENDING,
+  DATASET_ASCENDING
+} dataset_order_t;
+
+/* Bits of dataset_t.cached. */
+#define DATASET_CACHED_SUMMARY (1u << 0)
+#define DATASET_CACHED_MEDIAN (1u << 1)
+
+/**
+ * @brief A data-set and what is known about it.
+ *
+ * The statistics are only valid for the bits set in cached. Every sample
+ * type is represented exactly by a double, so they are kept as doubles.
+ */
+typedef struct {
+  void *data;
+  size_t len;
+  dataset_type_t type;
+  dataset_order_t order;
+  uint8_t cached;
+  double median;
+  double mean;
+  double maximum;
+  double minimum;
+  double variance;
+} dataset_t;
+
+/**
+ * @brief Wrap an array in a data-set handle.
+ *
+ * The array is not copied; it must outlive the handle, and should only be
+ * changed through it from now on.
+ *
+ * @param dataset A pointer to the handle.
+ * @param type The type of the array's samples.
+ * @param data A pointer to the array.
+ * @param len The length of the array; must be non-zero.
+ * @param order The order the array is known to be in, or DATASET_UNSORTED.
+ */
+void dataset_init(dataset_t *const dataset, const dataset_type_t type,
+                  void *const data, const size_t len,
+                  const dataset_order_t order);
+
+/**
+ * @brief Read one sample of a data-set.
+ *
+ * @param dataset A read-only pointer to the handle.
+ * @param index The index of the sample; below the length.
+ *
+ * @return The sample.
+ */
+double dataset_get(const dataset_t *const dataset, const size_t index);
+
+/**
+ * @brief Change one sample of a data-set.
+ *
+ * The cached statistics are dropped. The known order is kept if the new
+ * value still lies between its neighbours.
+ *
+ * @param dataset A pointer to the handle.
+ * @param index The index of the sample; below the length.
+ * @param value The new sample; converted to the sample type.
+ */
+void dataset_set(dataset_t *const dataset, const size_t index,
+                 const double value);
+
+/**
+ * @brief Get the array of a data-set to change it in bulk.
+ *
+ * The cached statistics and the known order are dropped, since the caller
+ * may write anything to the array.
+ *
+ * @param dataset A pointer to the handle.
+ *
+ * @return A pointer to the array.
+ */
+void *dataset_modify(dataset_t *const dataset);
+
+/**
+ * @brief Sort a data-set from largest to smallest.
+ *
+ * Does nothing if the data-set is known to be sorted that way, and reverses
+ * it if it is known to be sorted the other way. Otherwise one scan checks
+ * whether it is already in either order, stopping at the first sample that
+ * is not, before sort_array is called. The cached statistics are kept.
+ *
+ * @param dataset A pointer to the handle.
+ */
+void dataset_sort(dataset_t *const dataset);
+
+/**
+ * @brief Find the median of a data-set.
+ *
+ * On a sorted data-set this reads the middle samples. Otherwise the data-set
+ * is sorted with dataset_sort first, except for 8-bit samples, whose median
+ * comes with the other statistics from one histogram pass.
+ *
+ * @param dataset A pointer to the handle.
+ *
+ * @return The median, as find_median would give it after sort_array.
+ */
+double dataset_median(dataset_t *const dataset);
+
+/**
+ * @brief Find the mean of a data-set.
+ *
+ * The mean, maximum, minimum and variance are all found by one call to
+ * describe and cached together, unless the data-set is sorted, in which case
+ * the maximum and minimum are read from its ends.
+ *
+ * @param dataset A pointer to the handle.
+ *
+ * @return The mean, as find_mean would give it.
+ */
+double dataset_mean(dataset_t *const dataset);
+
+/**
+ * @brief Find the maximum of a data-set.
+ *
+ * @param dataset A pointer to the handle.
+ *
+ * @return The maximum.
+ */
+double dataset_maximum(dataset_t *const dataset);
+
+/**
+ * @brief Find the minimum of a data-set.
+ *
+ * @param dataset A pointer to the handle.
+ *
+ * @return The minimum.
+ */
+double dataset_minimum(dataset_t *const dataset);
+
+/**
+ * @brief Find the population variance of a data-set.
+ *
+ * @param dataset A pointer to the handle.
+ *
+ * @return The variance.
+ */
+double dataset_variance(dataset_t *const dataset);
+
+/**
+ * @brief Print the statistics of a data-set to stdout.
+ *
+ * This function prints in the same layout as print_statistics, finding any
+ * statistic that is not cached yet.
+ *
+ * @param dataset A pointer to the handle.
+ */
+void print_dataset(dataset_t *const dataset);
+
+#endif /* __DATASET_H__ */
@@ -0,0 +1,87 @@
+/******************************************************************************
+ * Copyright (C) 2025 by Michael Torres
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Michael Torres is not liable for any misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file extsort.h
+ * @brief Sorting capture files that are larger than memory.
+ *
+ * An external sort reads a capture file in chunks that fit a memory limit,
+ * sorts each chunk with sort_array into a run in a temporary file, and then
+ * merges the runs with a loser tree, reading and writing in large sequential
+ * blocks. The statistics of the samples are collected while the final merge
+ * writes the output, so the data is not read again for them. This module is
+ * only built for HOST.
+ *
+ * @author Michael Torres
+ * @date 10/18/26
+ *
+ */
+#ifndef __EXTSORT_H__
+#define __EXTSORT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Memory used when the caller passes a limit of zero, in bytes. */
+#define EXTERNAL_SORT_DEFAULT_MEMORY ((size_t)64 << 20)
+/* Smallest block read from or written to a file while merging, in bytes. */
+#define EXTERNAL_SORT_MIN_BLOCK ((size_t)64 << 10)
+/* Smallest memory limit; enough to merge two runs. */
+#define EXTERNAL_SORT_MIN_MEMORY (3 * EXTERNAL_SORT_MIN_BLOCK)
+
+/**
+ * @brief The statistics of a sorted capture file.
+ *
+ * median, maximum and minimum are as find_median_u16, find_maximum_u16 and
+ * find_minimum_u16 would give on the whole file, and mean as find_mean_u16.
+ */
+typedef struct {
+  uint64_t count;
+  uint64_t sum;
+  uint16_t median;
+  uint16_t mean;
+  uint16_t maximum;
+  uint16_t minimum;
+} external_sort_stats_t;
+
+/**
+ * @brief Sort a capture file of 16-bit samples from largest to smallest.
+ *
+ * The input is read as a raw array of native-endian uint16_t samples and the
+ * output is written the same way. Runs of half the memory limit are sorted in
+ * memory, as sort_array needs as much again for scratch. When there are more
+ * runs than the limit can hold a block of each, groups of them are first
+ * merged into longer runs in further temporary files. Temporary files come
+ * from tmpfile, so they are removed even if the program stops.
+ *
+ * @param input The path of the capture file to sort.
+ * @param output The path to write the sorted samples to; may not be input.
+ * @param memory_limit About the most memory to use, in bytes; zero for
+ *                     EXTERNAL_SORT_DEFAULT_MEMORY. Raised to
+ *                     EXTERNAL_SORT_MIN_MEMORY if less.
+ * @param stats A pointer to where to store the statistics of the samples, or
+ *              NULL. They are not stored for an empty input.
+ *
+ * @return 0 on success, or -1 if a file could not be read or written or
+ *         memory could not be reserved.
+ */
+int external_sort_u16(const char *const input, const char *const output,
+                      size_t memory_limit, external_sort_stats_t *const stats);
+
+/**
+ * @brief Print the statistics of a sorted capture file to stdout.
+ *
+ * This function prints in the same layout as print_statistics, with the
+ * number of samples first.
+ *
+ * @param stats A read-only pointer to the statistics.
+ */
+void print_external_sort_stats(const external_sort_stats_t *const stats);
+
+#endif /* __EXTSORT_H__ */
@@ -0,0 +1,162 @@
+/******************************************************************************
+ * Copyright (C) 2025 by Michael Torres
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Michael Torres is not liable for any misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file hll.h
+ * @brief Estimating the number of distinct values in a stream.
+ *
+ * Counting distinct values exactly means sorting them or remembering every
+ * one. A HyperLogLog sketch instead hashes each value, uses the first
+ * precision bits of the hash to pick one of 2^precision registers, and keeps
+ * in that register the longest run of leading zeros seen in the rest of the
+ * hash. The registers take 2^precision bytes whatever the stream, and the
+ * estimate has a standard error of about 1.04 / sqrt(2^precision): 0.8% at
+ * the default precision of 14.
+ *
+ * Until a sketch has seen HLL_SPARSE_CAPACITY distinct hashes it keeps them
+ * in a small hash set instead, at the finer HLL_SPARSE_PRECISION, which
+ * counts small streams almost exactly and leaves the registers untouched.
+ *
+ * @author Michael Torres
+ * @date 10/18/26
+ *
+ */
+#ifndef __HLL_H__
+#define __HLL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Range of precisions, in bits of register index. The registers are reserved
+ * from the heap, 2^precision bytes of them.
+ */
+#define HLL_MIN_PRECISION (4u)
+#if defined(HOST)
+#define HLL_MAX_PRECISION (18u)
+#define HLL_DEFAULT_PRECISION (14u)
+#else
+#define HLL_MAX_PRECISION (12u)
+#define HLL_DEFAULT_PRECISION (10u)
+#endif
+/* Bits of register index kept by the sparse set. */
+#define HLL_SPARSE_PRECISION (25u)
+/* Distinct hashes the sparse set holds before the registers are used; the
+ * set has twice as many slots so that probes stay short. */
+#ifndef HLL_SPARSE_CAPACITY
+#if defined(HOST)
+#define HLL_SPARSE_CAPACITY (1024u)
+#else
+#define HLL_SPARSE_CAPACITY (64u)
+#endif
+#endif
+#define HLL_SPARSE_SLOTS (2 * HLL_SPARSE_CAPACITY)
+
+/**
+ * @brief A HyperLogLog sketch.
+ *
+ * While is_dense is zero the sketch is the sparse_len used slots of sparse,
+ * each a register index at HLL_SPARSE_PRECISION shifted left by six bits
+ * above its run length, placed by the low bits of the index with linear
+ * probing; zero marks an empty slot. Once set, the sketch is the registers.
+ */
+typedef struct {
+  uint8_t *registers;
+  uint32_t sparse[HLL_SPARSE_SLOTS];
+  size_t sparse_len;
+  uint8_t precision;
+  uint8_t is_dense;
+} hll_t;
+
+/**
+ * @brief Start an empty sketch.
+ *
+ * @param hll A pointer to the sketch.
+ * @param precision The bits of register index, from HLL_MIN_PRECISION to
+ *                  HLL_MAX_PRECISION.
+ *
+ * @return 0 on success, or -1 if the precision is out of range or the
+ *         registers could not be reserved.
+ */
+int hll_init(hll_t *const hll, const unsigned int precision);
+
+/**
+ * @brief Free the registers of a sketch.
+ *
+ * @param hll A pointer to the sketch; it must be started again before use.
+ */
+void hll_free(hll_t *const hll);
+
+/**
+ * @brief Hash a value for a sketch.
+ *
+ * The splitmix64 finalizer: two multiplies that spread every input bit over
+ * all 64 output bits, so consecutive IDs land in unrelated registers.
+ *
+ * @param value The value to hash.
+ *
+ * @return The 64-bit hash.
+ */
+uint64_t hll_hash(const uint32_t value);
+
+/**
+ * @brief Add a value to a sketch.
+ *
+ * @param hll A pointer to the sketch.
+ * @param value The value.
+ */
+void hll_update(hll_t *const hll, const uint32_t value);
+
+/**
+ * @brief Add an array of values to a sketch.
+ *
+ * Once the sketch uses its registers this is a tight loop of hash, count
+ * leading zeros and keep the maximum.
+ *
+ * @param hll A pointer to the sketch.
+ * @param values A read-only pointer to the values.
+ * @param len A read-only number of values.
+ */
+void hll_update_batch(hll_t *const hll, const uint32_t *const values,
+                      const size_t len);
+
+/**
+ * @brief Merge one sketch into another.
+ *
+ * The result is the sketch of both streams together, so sketches of the parts
+ * of a stream can be built separately, e.g. one per thread.
+ *
+ * @param dst A pointer to the sketch to merge into.
+ * @param src A read-only pointer to the sketch to merge from.
+ *
+ * @return 0 on success, or -1 if the sketches have different precisions.
+ */
+int hll_merge(hll_t *const dst, const hll_t *const src);
+
+/**
+ * @brief Estimate the number of distinct values added to a sketch.
+ *
+ * A sparse sketch is counted by linear counting over its 2^25 fine registers.
+ * A dense one uses linear counting while many registers are still empty, and
+ * the harmonic mean of the registers after that.
+ *
+ * @param hll A read-only pointer to the sketch.
+ *
+ * @return The estimate.
+ */
+double hll_estimate(const hll_t *const hll);
+
+/**
+ * @brief Print the state and estimate of a sketch to stdout.
+ *
+ * @param hll A read-only pointer to the sketch.
+ */
+void print_hll(const hll_t *const hll);
+
+#endif /* __HLL_H__ */
@@ -0,0 +1,172 @@
+/******************************************************************************
+ * Copyright (C) 2025 by Michael Torres
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Michael Torres is not liable for any misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file packed.h
+ * @brief Compressed storage of 8-bit samples, with statistics on the blocks.
+ *
+ * Slowly varying sensor readings change by a few counts from one sample to
+ * the next. A packed_t stores them in blocks of PACKED_BLOCK_LEN: the first
+ * sample of a block is kept whole and every later one as its difference from
+ * the one before, zigzag-folded so that small steps either way are small
+ * numbers, and packed with just enough bits for the largest step in the
+ * block. A block that does not change at all takes no bits, which also makes
+ * long runs of one value cheap.
+ *
+ * Each block also keeps its minimum, maximum and sum in its header. The
+ * maximum, minimum or mean of a range is found from the headers of the
+ * blocks the range covers whole, and only the blocks at its two ends are
+ * decoded.
+ *
+ * @author Michael Torres
+ * @date 10/18/26
+ *
+ */
+#ifndef __PACKED_H__
+#define __PACKED_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Samples per block; at most 256 so that a block's sum fits 16 bits. */
+#ifndef PACKED_BLOCK_LEN
+#define PACKED_BLOCK_LEN (128u)
+#endif
+
+/**
+ * @brief The header of one block.
+ *
+ * The block's steps start offset bytes into the payload, bits bits each.
+ */
+typedef struct {
+  uint32_t offset;
+  uint16_t sum;
+  uint8_t first;
+  uint8_t minimum;
+  uint8_t maximum;
+  uint8_t bits;
+} packed_block_t;
+
+/**
+ * @brief Compressed 8-bit samples.
+ *
+ * len samples are held in (len + PACKED_BLOCK_LEN - 1) / PACKED_BLOCK_LEN
+ * blocks, whose steps take payload_len bytes of payload.
+ */
+typedef struct {
+  packed_block_t *blocks;
+  uint8_t *payload;
+  size_t len;
+  size_t capacity;
+  size_t payload_len;
+  size_t payload_capacity;
+} packed_t;
+
+/**
+ * @brief Find the most payload a number of samples can need.
+ *
+ * @param len The number of samples.
+ *
+ * @return The payload bytes of len samples that change by 128 every step.
+ */
+size_t packed_bound(const size_t len);
+
+/**
+ * @brief Reserve empty compressed storage.
+ *
+ * @param packed A pointer to the storage.
+ * @param capacity The most samples it will hold; must be non-zero.
+ * @param payload_bytes The bytes reserved for steps; packed_bound(capacity)
+ *                      is always enough, and slowly varying samples need a
+ *                      fraction of it.
+ *
+ * @return 0 on success, or -1 if the storage could not be reserved.
+ */
+int packed_init(packed_t *const packed, const size_t capacity,
+                const size_t payload_bytes);
+
+/**
+ * @brief Free compressed storage.
+ *
+ * @param packed A pointer to the storage; it must be reserved again before
+ *               use.
+ */
+void packed_free(packed_t *const packed);
+
+/**
+ * @brief Compress an array into storage, replacing what it held.
+ *
+ * @param packed A pointer to the storage.
+ * @param arr A read-only pointer to an array.
+ * @param len A read-only length of the pointed to array.
+ *
+ * @return 0 on success, or -1 if the storage is too small, in which case it
+ *         is left empty.
+ */
+int packed_encode(packed_t *const packed, const unsigned char *const arr,
+                  const size_t len);
+
+/**
+ * @brief Decompress a range of samples.
+ *
+ * @param packed A read-only pointer to the storage.
+ * @param start The index of the first sample of the range.
+ * @param count The number of samples; start + count is at most the length.
+ * @param dst A pointer to room for count samples.
+ */
+void packed_decode(const packed_t *const packed, const size_t start,
+                   const size_t count, unsigned char *const dst);
+
+/**
+ * @brief Find the maximum of a range of samples.
+ *
+ * @param packed A read-only pointer to the storage.
+ * @param start The index of the first sample of the range.
+ * @param count The number of samples; non-zero, and start + count is at most
+ *              the length.
+ *
+ * @return The maximum, as describe would give it.
+ */
+unsigned char packed_maximum(const packed_t *const packed, const size_t start,
+                             const size_t count);
+
+/**
+ * @brief Find the minimum of a range of samples.
+ *
+ * @param packed A read-only pointer to the storage.
+ * @param start The index of the first sample of the range.
+ * @param count The number of samples; non-zero, and start + count is at most
+ *              the length.
+ *
+ * @return The minimum, as describe would give it.
+ */
+unsigned char packed_minimum(const packed_t *const packed, const size_t start,
+                             const size_t count);
+
+/**
+ * @brief Find the mean of a range of samples.
+ *
+ * @param packed A read-only pointer to the storage.
+ * @param start The index of the first sample of the range.
+ * @param count The number of samples; non-zero, and start + count is at most
+ *              the length.
+ *
+ * @return The mean, rounded down as find_mean gives it.
+ */
+unsigned char packed_mean(const packed_t *const packed, const size_t start,
+                          const size_t count);
+
+/**
+ * @brief Print the size and compression of storage to stdout.
+ *
+ * @param packed A read-only pointer to the storage.
+ */
+void print_packed(const packed_t *const packed);
+
+#endif /* __PACKED_H__ */
@@ -0,0 +1,71 @@
+/******************************************************************************
+ * Copyright (C) 2025 by Michael Torres
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Michael Torres is not liable for any misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file search.h
+ * @brief Searching arrays that have been through sort_array.
+ *
+ * The bounds are found by a binary search whose loop has no data-dependent
+ * branch: each step picks the next half with a conditional move, so a large
+ * array costs one cache miss per level but no branch mispredictions. For
+ * many lookups in a large array, eytzinger_layout copies it into breadth-first
+ * order, where the first levels of the tree share a few cache lines and the
+ * next levels of a search are prefetched while the current one is compared.
+ * Like stats.h, the functions are generated for every sample type, with the
+ * unsigned char versions unsuffixed, and the upper-case macros pick the right
+ * version from the type of their array argument.
+ *
+ * @author Michael Torres
+ * @date 10/18/26
+ *
+ */
+#ifndef __SEARCH_H__
+#define __SEARCH_H__
+
+#include "stats.h"
+
+/* Cache line size; eytzinger searches prefetch one line of descendants. */
+#define SEARCH_CACHE_LINE (64u)
+
+#define SEARCH_SUFFIX
+#define SEARCH_T unsigned char
+#include "search_template.h"
+
+#define SEARCH_SUFFIX _u16
+#define SEARCH_T uint16_t
+#include "search_template.h"
+
+#define SEARCH_SUFFIX _s16
+#define SEARCH_T int16_t
+#include "search_template.h"
+
+#define SEARCH_SUFFIX _u32
+#define SEARCH_T uint32_t
+#include "search_template.h"
+
+#define SEARCH_SUFFIX _s32
+#define SEARCH_T int32_t
+#include "search_template.h"
+
+#define SEARCH_SUFFIX _f32
+#define SEARCH_T float
+#include "search_template.h"
+
+#define LOWER_BOUND(arr, len, value)                                           \
+  STATS_GENERIC((arr)[0], lower_bound)(arr, len, value)
+#define UPPER_BOUND(arr, len, value)                                           \
+  STATS_GENERIC((arr)[0], upper_bound)(arr, len, value)
+#define EYTZINGER_LAYOUT(arr, len, dst)                                        \
+  STATS_GENERIC((arr)[0], eytzinger_layout)(arr, len, dst)
+#define EYTZINGER_LOWER_BOUND(tree, len, value)                                \
+  STATS_GENERIC((tree)[0], eytzinger_lower_bound)(tree, len, value)
+#define EYTZINGER_UPPER_BOUND(tree, len, value)                                \
+  STATS_GENERIC((tree)[0], eytzinger_upper_bound)(tree, len, value)
+
+#endif /* __SEARCH_H__ */
@@ -0,0 +1,113 @@
+/******************************************************************************
+ * Copyright (C) 2025 by Michael Torres
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Michael Torres is not liable for any misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file search_template.h
+ * @brief The declarations of the search functions for one sample type.
+ *
+ * This file is included by search.h once per sample type, and has no include
+ * guard on purpose. Before each inclusion the following must be defined:
+ *
+ *   SEARCH_SUFFIX - appended to every function name; empty for unsigned char
+ *   SEARCH_T      - the sample type
+ *
+ * They are both undefined again at the end of this file.
+ *
+ * @author Michael Torres
+ * @date 10/18/26
+ *
+ */
+
+#define SEARCH_CAT_(a, b) a##b
+#define SEARCH_CAT(a, b) SEARCH_CAT_(a, b)
+#define SEARCH_FN(name) SEARCH_CAT(name, SEARCH_SUFFIX)
+
+/**
+ * @brief Find the first value of a sorted array not above a value.
+ *
+ * The array is in sort_array's largest-to-smallest order, so the index
+ * returned is also the number of values greater than value, and value could
+ * be inserted there, before any equal values, keeping the order.
+ *
+ * @param arr A read-only pointer to a sorted array.
+ * @param len A read-only length of the pointed to array.
+ * @param value The value to look for.
+ *
+ * @return The index of the first value less than or equal to value, or len if
+ *         there is none.
+ */
+size_t SEARCH_FN(lower_bound)(const SEARCH_T *const arr, const size_t len,
+                              const SEARCH_T value);
+
+/**
+ * @brief Find the first value of a sorted array below a value.
+ *
+ * The index returned is also the number of values greater than or equal to
+ * value; upper_bound - lower_bound is the number equal to it.
+ *
+ * @param arr A read-only pointer to a sorted array.
+ * @param len A read-only length of the pointed to array.
+ * @param value The value to look for.
+ *
+ * @return The index of the first value less than value, or len if there is
+ *         none.
+ */
+size_t SEARCH_FN(upper_bound)(const SEARCH_T *const arr, const size_t len,
+                              const SEARCH_T value);
+
+/**
+ * @brief Copy a sorted array into breadth-first (Eytzinger) order.
+ *
+ * tree[1] is the root of an implicit binary search tree and the children of
+ * tree[k] are tree[2k] and tree[2k + 1], the left one holding the larger
+ * values. tree[0] is not used.
+ *
+ * @param arr A read-only pointer to a sorted array.
+ * @param len A read-only length of the pointed to array.
+ * @param tree A pointer to room for len + 1 values; must not overlap arr.
+ */
+void SEARCH_FN(eytzinger_layout)(const SEARCH_T *const arr, const size_t len,
+                                 SEARCH_T *const tree);
+
+/**
+ * @brief Find the largest value not above a value in an Eytzinger tree.
+ *
+ * This finds the same value as lower_bound on the sorted array, but returns
+ * its position in the tree, since a tree position does not give its rank
+ * cheaply; keep the sorted array as well when ranks are needed. On HOST the
+ * descendants one cache line down are prefetched at every step.
+ *
+ * @param tree A read-only pointer to a tree from eytzinger_layout.
+ * @param len A read-only length of the array the tree was made from.
+ * @param value The value to look for.
+ *
+ * @return The index in tree of the value, or 0 if every value is greater.
+ */
+size_t SEARCH_FN(eytzinger_lower_bound)(const SEARCH_T *const tree,
+                                        const size_t len, const SEARCH_T value);
+
+/**
+ * @brief Find the largest value below a value in an Eytzinger tree.
+ *
+ * This finds the same value as upper_bound on the sorted array.
+ *
+ * @param tree A read-only pointer to a tree from eytzinger_layout.
+ * @param len A read-only length of the array the tree was made from.
+ * @param value The value to look for.
+ *
+ * @return The index in tree of the value, or 0 if no value is less.
+ */
+size_t SEARCH_FN(eytzinger_upper_bound)(const SEARCH_T *const tree,
+                                        const size_t len, const SEARCH_T value);
+
+#undef SEARCH_FN
+#undef SEARCH_CAT
+#undef SEARCH_CAT_
+#undef SEARCH_SUFFIX
+#undef SEARCH_T
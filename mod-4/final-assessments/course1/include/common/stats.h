@@ -13,7 +13,11 @@
  * @brief The header file for the statistics functions.
  *
  * All of the functions for this assignment will live here. The functions are,
- * in general, for calculating data and for printing data.
+ * in general, for calculating data and for printing data. The per-sample
+ * functions are declared once in stats_template.h and generated for every
+ * sample type below; the unsigned char versions keep their original names and
+ * the others carry a suffix naming their type. The upper-case macros at the
+ * end pick the right version from the type of their array argument.
  *
  * @author Michael Torres
  * @date 5/14/25
@@ -23,121 +27,639 @@
 #define __STATS_H__
 
 #include "platform.h"
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Inputs shorter than this are always handled by the calling thread. */
+#define PARALLEL_MIN_LEN (1u << 16)
+/* Upper bound on the number of worker threads used by the parallel paths. */
+#define MAX_THREADS (64)
+/* Number of bins in an 8-bit sample histogram. */
+#define HISTOGRAM_BINS (256)
+/* Arrays up to this length are sorted by a sorting network. */
+#define SORT_NETWORK_MAX_LEN (64)
+/* partial_sort keeps a heap when k is at most len / PARTIAL_SORT_HEAP_RATIO. */
+#define PARTIAL_SORT_HEAP_RATIO (16)
+
+/*
+ * Sub-histograms counted side by side by histogram_add. Sample i goes to
+ * sub-histogram i % HISTOGRAM_LANES, so a run of samples in one bin does not
+ * wait for each increment's store to land before loading the next.
+ */
+#define HISTOGRAM_LANES (4)
+
+/*
+ * Values tracked by a space-saving sketch, a power of two up to 32768, and
+ * its hash slots. A value that makes up more than 1 / FREQUENT_CAPACITY of a
+ * stream is always tracked.
+ */
+#ifndef FREQUENT_CAPACITY
+#if defined(HOST)
+#define FREQUENT_CAPACITY (256u)
+#else
+#define FREQUENT_CAPACITY (32u)
+#endif
+#endif
+#define FREQUENT_SLOTS (2 * FREQUENT_CAPACITY)
 
 /**
- * @brief Find array's median.
+ * @brief Counts of samples per bin, for bins over any sample type.
  *
- * This function, with read-only access, gets the median value stored in a
- * sorted array. This pre-requisite is important.
+ * The bins either split low to high into equal steps, when edges is NULL, or
+ * are given by bins + 1 ascending edges, bin i holding the samples from
+ * edges[i] up to but not including edges[i + 1]. Samples below the first bin,
+ * and NaNs, are counted in below; samples from the end of the last bin up are
+ * counted in above. The counts array belongs to the caller.
+ */
+typedef struct {
+  size_t *counts;
+  const double *edges;
+  double low;
+  /* bins / (high - low), so a sample's bin is (sample - low) * scale. */
+  double scale;
+  size_t bins;
+  size_t below;
+  size_t above;
+} histogram_t;
+
+/* The kinds of sample type, selecting each type's best algorithms. */
+#define STATS_KIND_BYTE (0)
+#define STATS_KIND_UNSIGNED (1)
+#define STATS_KIND_SIGNED (2)
+#define STATS_KIND_FLOAT (3)
+
+#define STATS_SUFFIX
+#define STATS_T unsigned char
+#define STATS_ACC_T uint64_t
+#define STATS_FMT "d"
+#define STATS_KIND STATS_KIND_BYTE
+#include "stats_template.h"
+
+#define STATS_SUFFIX _u16
+#define STATS_T uint16_t
+#define STATS_ACC_T uint64_t
+#define STATS_FMT PRIu16
+#define STATS_KIND STATS_KIND_UNSIGNED
+#include "stats_template.h"
+
+#define STATS_SUFFIX _s16
+#define STATS_T int16_t
+#define STATS_ACC_T int64_t
+#define STATS_FMT PRId16
+#define STATS_KIND STATS_KIND_SIGNED
+#include "stats_template.h"
+
+#define STATS_SUFFIX _u32
+#define STATS_T uint32_t
+#define STATS_ACC_T uint64_t
+#define STATS_FMT PRIu32
+#define STATS_KIND STATS_KIND_UNSIGNED
+#include "stats_template.h"
+
+#define STATS_SUFFIX _s32
+#define STATS_T int32_t
+#define STATS_ACC_T int64_t
+#define STATS_FMT PRId32
+#define STATS_KIND STATS_KIND_SIGNED
+#include "stats_template.h"
+
+#define STATS_SUFFIX _f32
+#define STATS_T float
+#define STATS_ACC_T double
+#define STATS_FMT "g"
+#define STATS_KIND STATS_KIND_FLOAT
+#include "stats_template.h"
+
+
+/**
+ * @brief Find the median, mean, max and min of an unsorted array.
  *
- * @param arr A read-only pointer to a sorted array.
- * @param len A read-only length of the pointed to array.
+ * This function, with read-only access, builds a histogram of the array and
+ * derives all four statistics from it, so the array does not need to be
+ * sorted first. The results match what find_median, find_mean, find_maximum
+ * and find_minimum return for the same data after sort_array. On HOST, arrays
+ * of at least PARALLEL_MIN_LEN values are split across the configured number of
+ * worker threads; each worker builds a partial histogram and sum which are
+ * merged afterwards.
  *
- * @return The median value.
+ * @param arr A read-only pointer to an array.
+ * @param len A read-only length of the pointed to array; must be non-zero.
+ * @param median Where the median value is stored.
+ * @param mean Where the mean value is stored.
+ * @param max Where the maximum value is stored.
+ * @param min Where the minimum value is stored.
  */
-unsigned char find_median(const unsigned char *const arr,
-                          const unsigned int len);
+void find_statistics(const unsigned char *const arr, const size_t len,
+                     unsigned char *const median, unsigned char *const mean,
+                     unsigned char *const max, unsigned char *const min);
 
 /**
- * @brief Find array's mean.
+ * @brief Find the statistics of many data-sets of the same length at once.
  *
- * This function, with read-only access, gets the mean value stored in an array.
+ * The data-sets are laid out as a structure of arrays: sample i of data-set d
+ * is samples[i * count + d], so each row of count bytes holds one sample of
+ * every data-set. The results match find_statistics for each data-set. On
+ * HOST with SSE2, data-sets of up to SORT_NETWORK_MAX_LEN samples are done 16
+ * at a time, one per vector lane: each row is one vector, sort_network's
+ * compare-exchange steps are applied to whole rows, and the sums are kept in
+ * 16-bit lanes. Other data-sets are done one at a time.
  *
- * @param arr A read-only pointer to an array.
- * @param len A read-only length of the pointed to array.
+ * @param samples A read-only pointer to len rows of count samples.
+ * @param len A read-only number of samples per data-set; must be non-zero.
+ * @param count A read-only number of data-sets.
+ * @param median Where the count medians are stored.
+ * @param mean Where the count means are stored.
+ * @param max Where the count maximums are stored.
+ * @param min Where the count minimums are stored.
+ */
+void find_statistics_batch(const unsigned char *const samples, const size_t len,
+                           const size_t count, unsigned char *const median,
+                           unsigned char *const mean, unsigned char *const max,
+                           unsigned char *const min);
+
+/**
+ * @brief Set the number of worker threads for the parallel paths.
  *
- * @return The mean value.
+ * This is what selects the parallel paths of find_mean, find_statistics and
+ * sort_array for large arrays. Only has an effect on HOST; the MSP432 always
+ * runs serially.
+ *
+ * @param count The number of threads, clamped to MAX_THREADS. Zero selects
+ *              the number of online processors.
  */
-unsigned char find_mean(const unsigned char *const arr, const unsigned int len);
+void set_thread_count(const unsigned int count);
 
 /**
- * @brief Find array's maximum.
+ * @brief Get the number of worker threads for the parallel paths.
  *
- * This function, with read-only access, gets the maximum value stored in a
- * sorted array. This pre-requisite is important.
+ * @return The number of threads that will be used; always at least one.
+ */
+unsigned int get_thread_count(void);
+
+/**
+ * @brief Find the variance of an array of 16-bit samples.
  *
- * @param arr A read-only pointer to a sorted array.
- * @param len A read-only length of the pointed to array.
+ * This function gets the population variance, the sum of squared distances
+ * from the mean divided by len, rounded down to an integer, in one pass over
+ * the array. The sums are exact 64-bit integers, so the result is the same on
+ * every platform; on the MSP432 the samples are summed and squared two at a
+ * time with the Cortex-M4 dual multiply-accumulate instructions.
  *
- * @return The maximum value.
+ * @param arr A read-only pointer to an array; it does not need to be sorted.
+ * @param len A read-only length of the pointed to array; must be non-zero and
+ *            below 2^32, so that the sum of the squares fits 64 bits.
+ *
+ * @return The variance, in squared sample units.
  */
-unsigned char find_maximum(const unsigned char *const arr,
-                           const unsigned int len);
+uint32_t find_variance_s16(const int16_t *const arr, const size_t len);
 
 /**
- * @brief Find array's minimum.
+ * @brief Find the standard deviation of an array of 16-bit samples.
  *
- * This function, with read-only access, gets the minimum value stored in a
- * sorted array. This pre-requisite is important.
+ * @param arr A read-only pointer to an array; it does not need to be sorted.
+ * @param len A read-only length of the pointed to array; must be non-zero.
  *
- * @param arr A read-only pointer to a sorted array.
- * @param len A read-only length of the pointed to array.
+ * @return The square root of find_variance_s16, rounded down.
+ */
+uint16_t find_stddev_s16(const int16_t *const arr, const size_t len);
+
+/**
+ * @brief Find the integer square root of a number.
+ *
+ * This function works one result bit at a time with shifts and adds, so it
+ * takes the same time for every value and needs no floating point.
+ *
+ * @param value The number.
  *
- * @return The maximum value.
+ * @return The largest integer whose square is at most value.
  */
-unsigned char find_minimum(const unsigned char *const arr,
-                           const unsigned int len);
+uint32_t integer_sqrt(const uint64_t value);
 
 /**
- * @brief Sort a given array from largest to smallest.
+ * @brief Running sums of two channels of 16-bit samples taken in pairs.
  *
- * This function sorts a given array in-place from largest to smallest using
- * quick sort.
+ * The sums are exact 64-bit integers, so accumulators of different parts of
+ * the channels, on different threads or devices, merge by adding them up and
+ * give the same results as one pass over everything.
+ */
+typedef struct {
+  uint64_t count;
+  int64_t sum_x;
+  int64_t sum_y;
+  uint64_t sum_xx;
+  uint64_t sum_yy;
+  int64_t sum_xy;
+} covariance_s16_t;
+
+/**
+ * @brief Start an empty paired accumulator.
  *
- * @param arr A pointer to an array.
- * @param len A read-only length of the pointed to array.
+ * @param covariance A pointer to the accumulator.
  */
-void sort_array(unsigned char *const arr, const unsigned int len);
+void covariance_init_s16(covariance_s16_t *const covariance);
 
 /**
- * @brief The recursive function that performs the quicksort procedure.
+ * @brief Add pairs of samples to a paired accumulator.
  *
- * This function is the "helper" recursive function used when a sort API of
- * just the array and length is used. This function calls the partitioning
- * function.
+ * All five sums are taken in one pass over both arrays. On HOST with SSE2,
+ * eight pairs at a time are multiplied and added in pairs with PMADDWD; on
+ * the MSP432 each SMLALD multiplies and adds two pairs into 64 bits.
  *
- * @param arr A pointer to an array.
- * @param low The current lowest index.
- * @param high The current highest index.
+ * @param covariance A pointer to the accumulator.
+ * @param x A read-only pointer to the first channel's samples.
+ * @param y A read-only pointer to the second channel's samples.
+ * @param len A read-only number of pairs; the accumulator's count must stay
+ *            below 2^32, so that the sums of the products fit 64 bits.
  */
-void quicksort(unsigned char *const arr, const int low, const int high);
+void covariance_update_s16(covariance_s16_t *const covariance,
+                           const int16_t *const x, const int16_t *const y,
+                           const size_t len);
 
 /**
- * @brief The partitioning function that splits down the array.
+ * @brief Add one paired accumulator to another.
  *
- * This function partitions the given array around a pivot point and moves
- * the data around that point. The pivot in this particular implementation is
- * chosen to be the value at the current highest index; arr[high].
+ * @param dst A pointer to the accumulator to add to.
+ * @param src A read-only pointer to the accumulator to add.
+ */
+void covariance_merge_s16(covariance_s16_t *const dst,
+                          const covariance_s16_t *const src);
+
+/**
+ * @brief Find the population covariance of the pairs in an accumulator.
  *
- * @param arr A pointer to an array.
- * @param low The current lowest index.
- * @param high The current highest index.
+ * @param covariance A read-only pointer to a non-empty accumulator.
  *
- * @return The index of the new pivoting index.
+ * @return The covariance, in the product of the channels' units.
  */
-int partition(unsigned char *const arr, const int low, const int high);
+double find_covariance_s16(const covariance_s16_t *const covariance);
 
 /**
- * @brief Print the statistics values to stdout.
+ * @brief Find the Pearson correlation of the pairs in an accumulator.
  *
- * This function prints all of the collected statistics from the input data.
+ * @param covariance A read-only pointer to a non-empty accumulator.
  *
- * @param median The median of the data-set.
- * @param mean The mean of the data-set.
- * @param max The max of the data-set.
- * @param min The min of the data-set.
+ * @return The correlation, from -1 to 1, or 0 if either channel is constant.
  */
-void print_statistics(const unsigned char median, const unsigned char mean,
-                      const unsigned char max, const unsigned char min);
+double find_correlation_s16(const covariance_s16_t *const covariance);
 
 /**
- * @brief Print the array values to stdout.
+ * @brief Fit y = slope * x + intercept to the pairs by least squares.
  *
- * This function prints all of the values in the given array.
+ * @param covariance A read-only pointer to a non-empty accumulator.
+ * @param slope Where the slope is stored; 0 if x is constant.
+ * @param intercept Where the intercept is stored; the mean of y if x is
+ *                  constant.
+ */
+void find_regression_s16(const covariance_s16_t *const covariance,
+                         double *const slope, double *const intercept);
+
+/**
+ * @brief Print the paired statistics of an accumulator to stdout.
  *
- * @param arr A read-only pointer to an array.
- * @param len A read-only length of the pointed to array.
+ * This function prints in the same layout as print_statistics.
+ *
+ * @param covariance A read-only pointer to a non-empty accumulator.
+ */
+void print_covariance_s16(const covariance_s16_t *const covariance);
+
+/*
+ * Accuracy of the quantile sketch. With K = 200, a quantile returned by
+ * quantile_sketch_query has a rank within about 1.33% of the count of the rank
+ * asked for, with 99% confidence (the KLL bound 2.296 / K^0.9723); a larger K
+ * tightens this at a cost of 12 bytes of sketch per unit of K.
+ */
+#ifndef QUANTILE_SKETCH_K
+#define QUANTILE_SKETCH_K (200)
+#endif
+/* Smallest capacity of a sketch level. */
+#define QUANTILE_SKETCH_MIN_LEVEL (8)
+/* Levels in a sketch; it holds about K * 2^(levels - 1) samples exactly. */
+#define QUANTILE_SKETCH_MAX_LEVELS (48)
+/* Samples a sketch can hold; enough for every level to reach capacity. */
+#define QUANTILE_SKETCH_CAPACITY                                               \
+  (3 * QUANTILE_SKETCH_K + QUANTILE_SKETCH_MIN_LEVEL * QUANTILE_SKETCH_MAX_LEVELS)
+
+/**
+ * @brief A fixed-memory KLL sketch of the quantiles of a stream of samples.
+ *
+ * The retained samples are kept in one array as consecutive levels, level 0
+ * highest; a sample at level h stands for 2^h samples of the stream. The free
+ * space is at the front of the array, where new samples enter level 0. Levels
+ * are sorted in place, so no function of the sketch reserves memory.
+ */
+typedef struct {
+  float items[QUANTILE_SKETCH_CAPACITY];
+  uint16_t level_start[QUANTILE_SKETCH_MAX_LEVELS + 1];
+  uint8_t levels;
+  uint32_t random;
+  uint64_t count;
+  float min;
+  float max;
+} quantile_sketch_t;
+
+/**
+ * @brief Start an empty quantile sketch.
+ *
+ * @param sketch A pointer to the sketch.
+ */
+void quantile_sketch_init(quantile_sketch_t *const sketch);
+
+/**
+ * @brief Add one sample to a quantile sketch.
+ *
+ * This takes amortized constant time. When the sketch is full, the lowest
+ * level that is over its capacity is sorted and every other sample in it is
+ * promoted to the next level, starting from a random one of the first two.
+ *
+ * @param sketch A pointer to the sketch.
+ * @param value The sample; must not be NaN.
+ */
+void quantile_sketch_update(quantile_sketch_t *const sketch, const float value);
+
+/**
+ * @brief Merge one quantile sketch into another.
+ *
+ * The result is a sketch of both streams, with the same error bound as if
+ * every sample had been added to dst. Each level of src goes into dst as a
+ * block, split only where dst has to be compacted to make room.
+ *
+ * @param dst A pointer to the sketch to merge into.
+ * @param src A read-only pointer to the sketch to merge from.
+ */
+void quantile_sketch_merge(quantile_sketch_t *const dst,
+                           const quantile_sketch_t *const src);
+
+/**
+ * @brief Find an approximate quantile of the samples in a quantile sketch.
+ *
+ * The minimum and maximum are exact; see QUANTILE_SKETCH_K for the bound on
+ * everything between. The order of the samples within each level is changed.
+ *
+ * @param sketch A pointer to a non-empty sketch.
+ * @param quantile The quantile, from 0 for the minimum to 1 for the maximum.
+ *
+ * @return A sample whose rank is close to quantile times the count.
+ */
+float quantile_sketch_query(quantile_sketch_t *const sketch,
+                            const float quantile);
+
+/**
+ * @brief Print the p50, p90, p99 and p999 quantiles to stdout.
+ *
+ * This function prints in the same layout as print_statistics.
+ *
+ * @param sketch A pointer to a non-empty sketch.
+ */
+void print_quantiles(quantile_sketch_t *const sketch);
+
+/*
+ * Size of a group table. Channel ids below GROUP_DENSE_KEYS index a dense
+ * array directly; the others are hashed into 2^GROUP_HASH_BITS slots with
+ * linear probing. A table takes 32 bytes per dense key and per slot.
+ */
+#ifndef GROUP_DENSE_KEYS
+#if defined(HOST)
+#define GROUP_DENSE_KEYS (256u)
+#else
+#define GROUP_DENSE_KEYS (16u)
+#endif
+#endif
+#ifndef GROUP_HASH_BITS
+#if defined(HOST)
+#define GROUP_HASH_BITS (10)
+#else
+#define GROUP_HASH_BITS (6)
+#endif
+#endif
+#define GROUP_HASH_SLOTS (1u << GROUP_HASH_BITS)
+
+/**
+ * @brief A sample tagged with the channel it came from.
+ */
+typedef struct {
+  uint32_t key;
+  int32_t value;
+} keyed_sample_t;
+
+/**
+ * @brief The running statistics of one channel.
+ *
+ * Accumulators merge by adding count and sum and taking the extreme minimum
+ * and maximum, so partial results can be combined in any order. A count of
+ * zero marks an unused entry.
+ */
+typedef struct {
+  uint64_t count;
+  int64_t sum;
+  uint32_t key;
+  int32_t minimum;
+  int32_t maximum;
+} group_stats_t;
+
+/**
+ * @brief Per-channel statistics of a stream of keyed samples.
+ *
+ * hashed counts the channels held in the hash slots, and dropped counts the
+ * samples of channels that found every slot taken.
+ */
+typedef struct {
+  group_stats_t dense[GROUP_DENSE_KEYS];
+  group_stats_t slots[GROUP_HASH_SLOTS];
+  size_t hashed;
+  uint64_t dropped;
+} group_table_t;
+
+/**
+ * @brief Start an empty group table.
+ *
+ * @param table A pointer to the table.
+ */
+void group_init(group_table_t *const table);
+
+/**
+ * @brief Add a batch of keyed samples to a group table.
+ *
+ * Each sample is looked up and folded into its channel's accumulator in a
+ * single pass. On HOST, batches of at least PARALLEL_MIN_LEN samples are split
+ * across the worker threads: each aggregates its slice into a table of its
+ * own, and the tables are then merged into this one. If the private tables
+ * cannot be reserved the batch is done on the calling thread.
+ *
+ * @param table A pointer to the table.
+ * @param samples A read-only pointer to the samples.
+ * @param len A read-only number of samples.
+ */
+void group_update(group_table_t *const table,
+                  const keyed_sample_t *const samples, const size_t len);
+
+/**
+ * @brief Merge one group table into another.
+ *
+ * @param dst A pointer to the table to merge into.
+ * @param src A read-only pointer to the table to merge from.
+ */
+void group_merge(group_table_t *const dst, const group_table_t *const src);
+
+/**
+ * @brief Find the statistics of one channel in a group table.
+ *
+ * @param table A read-only pointer to the table.
+ * @param key The channel id.
+ *
+ * @return A read-only pointer to the channel's accumulator, or NULL if no
+ *         sample of the channel has been added.
+ */
+const group_stats_t *group_find(const group_table_t *const table,
+                                const uint32_t key);
+
+/**
+ * @brief Find the mean of one channel's samples.
+ *
+ * @param stats A read-only pointer to a used accumulator.
+ *
+ * @return The mean value, truncated towards zero as find_mean does.
+ */
+int32_t group_mean(const group_stats_t *const stats);
+
+/**
+ * @brief Print the statistics of every channel in a group table to stdout.
+ *
+ * One line per channel, dense channels first in key order and then the
+ * hashed ones in slot order.
+ *
+ * @param table A read-only pointer to the table.
+ */
+void print_groups(const group_table_t *const table);
+
+/**
+ * @brief Start an empty histogram of equal-width bins.
+ *
+ * @param histogram A pointer to the histogram.
+ * @param counts A pointer to room for bins counts; they are zeroed.
+ * @param bins The number of bins; at least one, and below 2^31.
+ * @param low The lower edge of the first bin.
+ * @param high The upper edge of the last bin; above low.
+ */
+void histogram_init_uniform(histogram_t *const histogram, size_t *const counts,
+                            const size_t bins, const double low,
+                            const double high);
+
+/**
+ * @brief Start an empty histogram of bins between given edges.
+ *
+ * @param histogram A pointer to the histogram.
+ * @param counts A pointer to room for bins counts; they are zeroed.
+ * @param bins The number of bins; at least one.
+ * @param edges A read-only pointer to bins + 1 ascending edges, which must
+ *              outlive the histogram.
+ */
+void histogram_init_edges(histogram_t *const histogram, size_t *const counts,
+                          const size_t bins, const double *const edges);
+
+/**
+ * @brief Add the counts of one histogram to another with the same bins.
+ *
+ * @param dst A pointer to the histogram to add to.
+ * @param src A read-only pointer to the histogram to add.
+ */
+void histogram_merge(histogram_t *const dst, const histogram_t *const src);
+
+/**
+ * @brief Print a histogram to stdout, one line per non-empty bin.
+ *
+ * Each line has the bin's edges, its count and a bar scaled to the largest
+ * count. Runs of empty bins are folded into one line, so a large data-set is
+ * summed up in a screenful where print_array would print every sample.
+ *
+ * @param histogram A read-only pointer to the histogram.
+ */
+void print_histogram(const histogram_t *const histogram);
+
+/*
+ * Type-generic front ends. Each expands to the version of the function for
+ * the element type of its first argument, with or without const, e.g.
+ * FIND_MEAN(samples, len) calls find_mean_u16 for a uint16_t array.
+ */
+#define STATS_GENERIC(sample, name)                                            \
+  _Generic((sample),                                                           \
+      unsigned char: name,                                                     \
+      uint16_t: name##_u16,                                                    \
+      int16_t: name##_s16,                                                     \
+      uint32_t: name##_u32,                                                    \
+      int32_t: name##_s32,                                                     \
+      float: name##_f32)
+
+#define FIND_MEDIAN(arr, len) STATS_GENERIC((arr)[0], find_median)(arr, len)
+#define SELECT_KTH(arr, len, k) STATS_GENERIC((arr)[0], select_kth)(arr, len, k)
+#define FIND_MEDIAN_SELECT(arr, len)                                           \
+  STATS_GENERIC((arr)[0], find_median_select)(arr, len)
+#define FIND_MEAN(arr, len) STATS_GENERIC((arr)[0], find_mean)(arr, len)
+#define FIND_MAXIMUM(arr, len) STATS_GENERIC((arr)[0], find_maximum)(arr, len)
+#define FIND_MINIMUM(arr, len) STATS_GENERIC((arr)[0], find_minimum)(arr, len)
+#define SORT_NETWORK(arr, len) STATS_GENERIC((arr)[0], sort_network)(arr, len)
+#define PARTIAL_SORT(arr, len, k)                                              \
+  STATS_GENERIC((arr)[0], partial_sort)(arr, len, k)
+#define TOP_K(arr, len, dst, k) STATS_GENERIC((arr)[0], top_k)(arr, len, dst, k)
+#define BOTTOM_K(arr, len, dst, k)                                             \
+  STATS_GENERIC((arr)[0], bottom_k)(arr, len, dst, k)
+/*
+ * A length known at compile time to fit a sorting network goes straight to
+ * it, skipping sort_array's checks; the other branch is then discarded.
+ */
+#define SORT_ARRAY(arr, len)                                                   \
+  (__builtin_constant_p(len) && (len) <= SORT_NETWORK_MAX_LEN                  \
+       ? SORT_NETWORK(arr, len)                                                \
+       : STATS_GENERIC((arr)[0], sort_array)(arr, len))
+#define RADIX_SORT(arr, len)                                                   \
+  _Generic((arr)[0],                                                           \
+      uint16_t: radix_sort_u16,                                                \
+      int16_t: radix_sort_s16,                                                 \
+      uint32_t: radix_sort_u32,                                                \
+      int32_t: radix_sort_s32,                                                 \
+      float: radix_sort_f32)(arr, len)
+#define ARGSORT(arr, len, indices)                                             \
+  STATS_GENERIC((arr)[0], argsort)(arr, len, indices)
+/*
+ * Sorts an array of structs by one of their sample fields, e.g.
+ * SORT_RECORDS(readings, len, value) for an array of
+ * struct { uint32_t time; int16_t value; }.
+ */
+#define SORT_RECORDS(records, len, field)                                      \
+  STATS_GENERIC((records)[0].field, sort_records)(                             \
+      records, len, sizeof((records)[0]),                                      \
+      (size_t)((const char *)&(records)[0].field - (const char *)(records)))
+#define DESCRIBE(arr, len, scratch)                                            \
+  STATS_GENERIC((arr)[0], describe)(arr, len, scratch)
+#define PRINT_DESCRIPTION(description)                                         \
+  _Generic((description),                                                      \
+      description_t: print_description,                                        \
+      description_u16_t: print_description_u16,                                \
+      description_s16_t: print_description_s16,                                \
+      description_u32_t: print_description_u32,                                \
+      description_s32_t: print_description_s32,                                \
+      description_f32_t: print_description_f32)(&(description))
+#define PRINT_STATISTICS_VALUES(median, mean, max, min)                        \
+  STATS_GENERIC(median, print_statistics)(median, mean, max, min)
+/*
+ * PRINT_STATISTICS(median, mean, max, min) prints four values and
+ * PRINT_STATISTICS(description) prints a summary from describe.
  */
-void print_array(const unsigned char *const arr, const unsigned int len);
+#define STATS_FIFTH_(a, b, c, d, name, ...) name
+#define PRINT_STATISTICS(...)                                                  \
+  STATS_FIFTH_(__VA_ARGS__, PRINT_STATISTICS_VALUES, , , PRINT_DESCRIPTION, ) \
+  (__VA_ARGS__)
+#define FLAG_OUTLIERS_MAD(arr, len, threshold, scratch, mask)                  \
+  STATS_GENERIC((arr)[0], flag_outliers_mad)(arr, len, threshold, scratch, mask)
+#define FLAG_OUTLIERS_IQR(arr, len, factor, scratch, mask)                     \
+  STATS_GENERIC((arr)[0], flag_outliers_iqr)(arr, len, factor, scratch, mask)
+#define FIND_MODE(arr, len) STATS_GENERIC((arr)[0], find_mode)(arr, len)
+#define TOP_FREQUENT(arr, len, values, counts, n)                              \
+  STATS_GENERIC((arr)[0], top_frequent)(arr, len, values, counts, n)
+#define FREQUENT_UPDATE(sketch, arr, len)                                      \
+  STATS_GENERIC((arr)[0], frequent_update)(sketch, arr, len)
+#define HISTOGRAM_ADD(histogram, arr, len)                                     \
+  STATS_GENERIC((arr)[0], histogram_add)(histogram, arr, len)
+#define PRINT_ARRAY(arr, len) STATS_GENERIC((arr)[0], print_array)(arr, len)
 
 #endif /* __STATS_H__ */
@@ -0,0 +1,541 @@
+/******************************************************************************
+ * Copyright (C) 2025 by Michael Torres
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Michael Torres is not liable for any misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file stats_template.h
+ * @brief The declarations of the statistics functions for one sample type.
+ *
+ * This file is included by stats.h once per sample type, and has no include
+ * guard on purpose. Before each inclusion the following must be defined:
+ *
+ *   STATS_SUFFIX - appended to every function name; empty for unsigned char
+ *   STATS_T      - the sample type
+ *   STATS_ACC_T  - a type wide enough to sum any array of samples
+ *   STATS_FMT    - the printf conversion, without the '%', for a sample
+ *   STATS_KIND   - one of STATS_KIND_BYTE, _UNSIGNED, _SIGNED or _FLOAT
+ *
+ * They are all undefined again at the end of this file.
+ *
+ * @author Michael Torres
+ * @date 10/18/26
+ *
+ */
+
+#define STATS_CAT_(a, b) a##b
+#define STATS_CAT(a, b) STATS_CAT_(a, b)
+#define STATS_FN(name) STATS_CAT(name, STATS_SUFFIX)
+#define STATS_TYPE(name) STATS_CAT(STATS_FN(name), _t)
+
+/**
+ * @brief A summary of an array, as found by describe.
+ *
+ * median is only set when has_median is non-zero.
+ */
+typedef struct {
+  size_t count;
+  STATS_ACC_T sum;
+  STATS_T mean;
+  STATS_T minimum;
+  STATS_T maximum;
+  double variance;
+  int has_median;
+  STATS_T median;
+} STATS_TYPE(description);
+
+/**
+ * @brief A space-saving sketch of the most frequent values of a stream.
+ *
+ * The tracked values are kept as a min-heap by count in values, counts and
+ * errors. A value not yet tracked takes over the least counted one, with
+ * that count + 1 as its own and that count as its error, so every count is
+ * at most error above the true count. slots is a hash table of heap
+ * positions + 1, zero marking an empty slot, and slot_of gives each heap
+ * position's slot.
+ */
+typedef struct {
+  STATS_T values[FREQUENT_CAPACITY];
+  size_t counts[FREQUENT_CAPACITY];
+  size_t errors[FREQUENT_CAPACITY];
+  uint16_t slot_of[FREQUENT_CAPACITY];
+  uint16_t slots[FREQUENT_SLOTS];
+  size_t used;
+  size_t total;
+} STATS_TYPE(frequent);
+
+/**
+ * @brief Find array's median.
+ *
+ * This function, with read-only access, gets the median value stored in a
+ * sorted array. This pre-requisite is important. For even lengths the two
+ * middle values are averaged, truncating towards zero for integer types.
+ *
+ * @param arr A read-only pointer to a sorted array.
+ * @param len A read-only length of the pointed to array.
+ *
+ * @return The median value.
+ */
+STATS_T STATS_FN(find_median)(const STATS_T *const arr, const size_t len);
+
+/**
+ * @brief Find the value that would be at an index after sort_array.
+ *
+ * This function finds the k-th largest value (counting from zero) with
+ * introselect: quickselect with a median-of-three pivot, falling back to a
+ * median-of-medians pivot once too many partitions have been spent, which
+ * keeps it linear in both the expected and the worst case. The array does not
+ * need to be sorted. On return arr[k] holds the value, every value before it
+ * is greater than or equal to it and every value after it is less than or
+ * equal to it; the order within those two parts is unspecified.
+ *
+ * @param arr A pointer to an array; it is reordered.
+ * @param len A read-only length of the pointed to array.
+ * @param k A read-only index in largest-to-smallest order; must be below len.
+ *
+ * @return The k-th largest value.
+ */
+STATS_T STATS_FN(select_kth)(STATS_T *const arr, const size_t len,
+                             const size_t k);
+
+/**
+ * @brief Find array's median without sorting it first.
+ *
+ * This function gets the same median as find_median does on a sorted array,
+ * including the averaging of the two middle values for even lengths, but uses
+ * select_kth so it runs in linear time on unsorted data.
+ *
+ * @param arr A pointer to an array; it is reordered.
+ * @param len A read-only length of the pointed to array; must be non-zero.
+ *
+ * @return The median value.
+ */
+STATS_T STATS_FN(find_median_select)(STATS_T *const arr, const size_t len);
+
+/**
+ * @brief Find array's mean.
+ *
+ * This function, with read-only access, gets the mean value stored in an array.
+ * The sum is kept in STATS_ACC_T, 64 bits for integer samples, so it cannot
+ * overflow for any length. 8-bit and 16-bit samples are first summed in blocks
+ * short enough for a 16-bit or 32-bit sum, which vector lanes can hold, and
+ * floats are summed in double with compensated summation.
+ *
+ * @param arr A read-only pointer to an array.
+ * @param len A read-only length of the pointed to array.
+ *
+ * @return The mean value.
+ */
+STATS_T STATS_FN(find_mean)(const STATS_T *const arr, const size_t len);
+
+/**
+ * @brief Find array's maximum.
+ *
+ * This function, with read-only access, gets the maximum value stored in a
+ * sorted array. This pre-requisite is important.
+ *
+ * @param arr A read-only pointer to a sorted array.
+ * @param len A read-only length of the pointed to array.
+ *
+ * @return The maximum value.
+ */
+STATS_T STATS_FN(find_maximum)(const STATS_T *const arr, const size_t len);
+
+/**
+ * @brief Find array's minimum.
+ *
+ * This function, with read-only access, gets the minimum value stored in a
+ * sorted array. This pre-requisite is important.
+ *
+ * @param arr A read-only pointer to a sorted array.
+ * @param len A read-only length of the pointed to array.
+ *
+ * @return The minimum value.
+ */
+STATS_T STATS_FN(find_minimum)(const STATS_T *const arr, const size_t len);
+
+/**
+ * @brief Move the k largest values of an array to its front, sorted.
+ *
+ * This function leaves arr[0] to arr[k - 1] as sort_array would, and the rest
+ * of the array in no particular order, in O(len log k) time. For k up to
+ * len / PARTIAL_SORT_HEAP_RATIO the front is kept as a bounded heap while the
+ * rest of the array is scanned; for larger k, select_kth splits off the front,
+ * which is then sorted.
+ *
+ * @param arr A pointer to an array; it is reordered.
+ * @param len A read-only length of the pointed to array.
+ * @param k A read-only number of values; at most len.
+ */
+void STATS_FN(partial_sort)(STATS_T *const arr, const size_t len,
+                            const size_t k);
+
+/**
+ * @brief Copy the k largest values of an array, from largest to smallest.
+ *
+ * This function keeps the k largest values seen so far in dst as a bounded
+ * heap, which takes O(len log k) time and leaves arr as it is.
+ *
+ * @param arr A read-only pointer to an array.
+ * @param len A read-only length of the pointed to array.
+ * @param dst A pointer to room for k values.
+ * @param k A read-only number of values; at most len.
+ */
+void STATS_FN(top_k)(const STATS_T *const arr, const size_t len,
+                     STATS_T *const dst, const size_t k);
+
+/**
+ * @brief Copy the k smallest values of an array, from smallest to largest.
+ *
+ * This function is top_k for the other end of the array.
+ *
+ * @param arr A read-only pointer to an array.
+ * @param len A read-only length of the pointed to array.
+ * @param dst A pointer to room for k values.
+ * @param k A read-only number of values; at most len.
+ */
+void STATS_FN(bottom_k)(const STATS_T *const arr, const size_t len,
+                        STATS_T *const dst, const size_t k);
+
+/**
+ * @brief Summarize an array in a single pass over it.
+ *
+ * This function finds the count, sum, mean, minimum, maximum and population
+ * variance of an unsorted array while reading it once, instead of a sort and
+ * one pass per statistic. The mean, minimum and maximum match find_mean,
+ * find_minimum and find_maximum. 8-bit samples are counted into a histogram,
+ * in parallel on HOST for large arrays, from which every statistic follows,
+ * including the median. 16-bit samples keep exact integer sums, 8 at a time
+ * on HOST with SSE2, and need fewer than 2^32 samples for the squares to fit.
+ * Wider samples sum their distances from the first sample in double
+ * precision, so a large offset does not swamp the variance; floats keep their
+ * sum with the same compensated summation as find_mean.
+ *
+ * For samples wider than 8 bits the median needs the samples in a place they
+ * can be reordered: when scratch is given, the samples are copied to it as
+ * they are read and the median is then found there with find_median_select.
+ *
+ * @param arr A read-only pointer to an array.
+ * @param len A read-only length of the pointed to array; must be non-zero.
+ * @param scratch A pointer to room for len samples, or NULL to skip the
+ *                median; not used for 8-bit samples.
+ *
+ * @return The summary.
+ */
+STATS_TYPE(description)
+STATS_FN(describe)(const STATS_T *const arr, const size_t len,
+                   STATS_T *const scratch);
+
+/**
+ * @brief Flag the samples that lie far from the median.
+ *
+ * A sample is an outlier when its distance from the median is more than
+ * threshold times the scaled median absolute deviation, 1.4826 * MAD, which
+ * estimates the standard deviation of normal data but is not moved by the
+ * outliers themselves. The median is found with select_kth in a copy of the
+ * array. The selection of the median distance then starts with a partition
+ * that reads the samples of that copy and writes their distances over it,
+ * so the distances take no pass of their own. There is no sort and no
+ * allocation, so the cost is linear and fixed by len. If more than half of
+ * the samples equal the median, MAD is zero and every other sample is
+ * flagged.
+ *
+ * @param arr A read-only pointer to an array.
+ * @param len A read-only length of the pointed to array; must be non-zero.
+ * @param threshold The number of scaled MADs beyond which a sample is flagged;
+ *                  3 is usual.
+ * @param scratch A pointer to room for len samples.
+ * @param mask Where bit i % 8 of byte i / 8 is set for an outlier at index i;
+ *             (len + 7) / 8 bytes.
+ *
+ * @return The number of outliers.
+ */
+size_t STATS_FN(flag_outliers_mad)(const STATS_T *const arr, const size_t len,
+                                   const float threshold,
+                                   STATS_T *const scratch, uint8_t *const mask);
+
+/**
+ * @brief Flag the samples that lie outside Tukey's fences.
+ *
+ * The upper quartile is the value sort_array would put at len / 4 and the
+ * lower quartile the one at len - 1 - len / 4. Both are selected in a copy of
+ * the array, the second in the part the first selection left below it. A
+ * sample is an outlier when it is more than factor times their difference
+ * above the upper quartile or below the lower one.
+ *
+ * @param arr A read-only pointer to an array.
+ * @param len A read-only length of the pointed to array; must be non-zero.
+ * @param factor The multiple of the interquartile range; 1.5 is usual.
+ * @param scratch A pointer to room for len samples.
+ * @param mask Where bit i % 8 of byte i / 8 is set for an outlier at index i;
+ *             (len + 7) / 8 bytes.
+ *
+ * @return The number of outliers.
+ */
+size_t STATS_FN(flag_outliers_iqr)(const STATS_T *const arr, const size_t len,
+                                   const float factor, STATS_T *const scratch,
+                                   uint8_t *const mask);
+
+/**
+ * @brief Find the most frequent value of an array.
+ *
+ * This is top_frequent for one value, without the sort and run scan it
+ * replaces.
+ *
+ * @param arr A read-only pointer to an array.
+ * @param len A read-only length of the pointed to array; must be non-zero.
+ *
+ * @return The most frequent value, the largest of them if several tie.
+ */
+STATS_T STATS_FN(find_mode)(const STATS_T *const arr, const size_t len);
+
+/**
+ * @brief Find the most frequent values of an array and how often they occur.
+ *
+ * 8-bit samples are counted into a histogram. Wider samples are counted in
+ * a hash table that starts with 256 slots and doubles whenever more than
+ * half of them are used, so past 256 it holds two to four slots per
+ * distinct value however long the array is; its slots are then scanned for
+ * the n largest counts. If the table cannot be reserved, at the start or
+ * when it grows, it is freed and the whole array is fed through a
+ * space-saving sketch instead, so the counts may be too high by up to
+ * len / FREQUENT_CAPACITY; a value more frequent than that is still always
+ * found.
+ *
+ * @param arr A read-only pointer to an array.
+ * @param len A read-only length of the pointed to array.
+ * @param values Where the values are written, most frequent first and the
+ *               largest first among equal counts; room for n.
+ * @param counts Where the number of occurrences of each value is written;
+ *               room for n.
+ * @param n The most values to find.
+ *
+ * @return The number of values written: n, or fewer if the array has fewer
+ *         distinct values.
+ */
+size_t STATS_FN(top_frequent)(const STATS_T *const arr, const size_t len,
+                              STATS_T *const values, size_t *const counts,
+                              const size_t n);
+
+/**
+ * @brief Start an empty space-saving sketch.
+ *
+ * @param sketch A pointer to the sketch.
+ */
+void STATS_FN(frequent_init)(STATS_TYPE(frequent) *const sketch);
+
+/**
+ * @brief Add samples of a stream to a space-saving sketch.
+ *
+ * Each sample costs a hash lookup and a sift down the heap of
+ * FREQUENT_CAPACITY counts, whatever the length of the stream.
+ *
+ * @param sketch A pointer to the sketch.
+ * @param arr A read-only pointer to the samples.
+ * @param len A read-only number of samples.
+ */
+void STATS_FN(frequent_update)(STATS_TYPE(frequent) *const sketch,
+                               const STATS_T *const arr, const size_t len);
+
+/**
+ * @brief Find the most frequent values seen by a space-saving sketch.
+ *
+ * @param sketch A read-only pointer to the sketch.
+ * @param values Where the values are written, highest count first and the
+ *               largest first among equal counts; room for n.
+ * @param counts Where the count of each value is written; each is at most
+ *               total / FREQUENT_CAPACITY above the true count. Room for n.
+ * @param n The most values to find.
+ *
+ * @return The number of values written: n, or fewer if fewer are tracked.
+ */
+size_t STATS_FN(frequent_top)(const STATS_TYPE(frequent) *const sketch,
+                              STATS_T *const values, size_t *const counts,
+                              const size_t n);
+
+/**
+ * @brief Sort a given array from largest to smallest.
+ *
+ * This function sorts a given array in-place from largest to smallest with
+ * the best sort for the sample type and length: sort_network up to
+ * SORT_NETWORK_MAX_LEN values, then a counting sort for 8-bit samples and
+ * radix_sort for wider samples. On HOST, arrays of at least
+ * PARALLEL_MIN_LEN values are sorted by get_thread_count() threads: 8-bit
+ * samples build their histogram in parallel, and wider samples use a sample
+ * sort that radix sorts one bucket per thread. set_thread_count(1) turns this
+ * off.
+ *
+ * @param arr A pointer to an array.
+ * @param len A read-only length of the pointed to array.
+ */
+void STATS_FN(sort_array)(STATS_T *const arr, const size_t len);
+
+/**
+ * @brief Sort a small array from largest to smallest with a sorting network.
+ *
+ * This function runs Batcher's merge-exchange network for len values: a fixed
+ * sequence of compare-exchange steps that does not depend on the data, with
+ * no branches on the values. On HOST with SSE2 the steps are done a vector
+ * at a time: 8-bit samples 16 values at a time with vector min/max, and
+ * wider samples 8 or 4 comparators at a time wherever a step's comparators
+ * are far enough apart. When len is a compile-time constant the SORT_ARRAY
+ * macro calls this directly.
+ *
+ * @param arr A pointer to an array.
+ * @param len A read-only length of the pointed to array; at most
+ *            SORT_NETWORK_MAX_LEN.
+ */
+void STATS_FN(sort_network)(STATS_T *const arr, const size_t len);
+
+#if STATS_KIND != STATS_KIND_BYTE
+/**
+ * @brief Sort a given array from largest to smallest with an LSD radix sort.
+ *
+ * This function maps each sample to an unsigned key whose ascending order is
+ * the samples' descending order (flipping the sign bit for signed samples and
+ * all bits of negative floats), then makes one stable counting pass per 8-bit
+ * digit, or 11-bit digit for 32-bit samples on HOST. Digits that are the same
+ * for every sample are skipped. A single scratch array of len samples is taken
+ * from reserve_words; if that fails the array is heap sorted in place
+ * instead, which needs no stack beyond a few locals. NaN floats are not
+ * supported.
+ *
+ * @param arr A pointer to an array.
+ * @param len A read-only length of the pointed to array.
+ */
+void STATS_FN(radix_sort)(STATS_T *const arr, const size_t len);
+#endif
+
+/**
+ * @brief Find the order sort_array would put an array in, without moving it.
+ *
+ * This function stores in indices[0] the index of the largest value, in
+ * indices[1] the index of the next largest and so on; equal values keep the
+ * order they have in arr. It radix sorts compact key/index pairs, so it takes
+ * linear time, with a scratch array of 2 * len pairs from reserve_words.
+ *
+ * @param arr A read-only pointer to an array.
+ * @param len A read-only length of the pointed to array.
+ * @param indices A pointer to room for len indices.
+ *
+ * @return 0 on success, or -1 if the scratch array could not be reserved, in
+ *         which case indices is not written.
+ */
+int STATS_FN(argsort)(const STATS_T *const arr, const size_t len,
+                      size_t *const indices);
+
+/**
+ * @brief Sort an array of records from largest to smallest by a sample field.
+ *
+ * This function sorts key/index pairs like argsort, then moves each record
+ * once, straight to its place, by following the cycles of the permutation.
+ * Records with equal keys keep their order, so the sort is stable. Only one
+ * record is ever copied aside, so records can be large. The SORT_RECORDS
+ * macro fills in the size and offset from a record array and field name.
+ *
+ * @param records A pointer to an array of records.
+ * @param len A read-only number of records.
+ * @param size A read-only size of one record, in bytes.
+ * @param key_offset A read-only offset of the sample in a record, in bytes.
+ *
+ * @return 0 on success, or -1 if the scratch array could not be reserved, in
+ *         which case the records are not moved.
+ */
+int STATS_FN(sort_records)(void *const records, const size_t len,
+                           const size_t size, const size_t key_offset);
+
+/**
+ * @brief The recursive function that performs the quicksort procedure.
+ *
+ * This function is the "helper" recursive function used when a sort API of
+ * just the array and length is used. This function calls the partitioning
+ * function.
+ *
+ * @param arr A pointer to an array.
+ * @param low The current lowest index.
+ * @param high The current highest index.
+ */
+void STATS_FN(quicksort)(STATS_T *const arr, const ptrdiff_t low,
+                         const ptrdiff_t high);
+
+/**
+ * @brief The partitioning function that splits down the array.
+ *
+ * This function partitions the given array around a pivot point and moves
+ * the data around that point. The pivot in this particular implementation is
+ * chosen to be the value at the current highest index; arr[high].
+ *
+ * @param arr A pointer to an array.
+ * @param low The current lowest index.
+ * @param high The current highest index.
+ *
+ * @return The index of the new pivoting index.
+ */
+ptrdiff_t STATS_FN(partition)(STATS_T *const arr, const ptrdiff_t low,
+                              const ptrdiff_t high);
+
+/**
+ * @brief Count an array's samples into the bins of a histogram.
+ *
+ * Each thread counts into HISTOGRAM_LANES sub-histograms of its own, which
+ * are added to the histogram at the end. On HOST with SSE2, the bins of four
+ * samples of equal-width bins are found at once; given edges are searched
+ * without branches. 8-bit samples are counted into 256 values first, and
+ * each value's bin is found once. On HOST, arrays of at least
+ * PARALLEL_MIN_LEN samples are split across the worker threads.
+ *
+ * @param histogram A pointer to the histogram.
+ * @param arr A read-only pointer to an array.
+ * @param len A read-only length of the pointed to array.
+ */
+void STATS_FN(histogram_add)(histogram_t *const histogram,
+                             const STATS_T *const arr, const size_t len);
+
+/**
+ * @brief Print the statistics values to stdout.
+ *
+ * This function prints all of the collected statistics from the input data.
+ *
+ * @param median The median of the data-set.
+ * @param mean The mean of the data-set.
+ * @param max The max of the data-set.
+ * @param min The min of the data-set.
+ */
+void STATS_FN(print_statistics)(const STATS_T median, const STATS_T mean,
+                                const STATS_T max, const STATS_T min);
+
+/**
+ * @brief Print a summary from describe to stdout.
+ *
+ * This function prints the summary in the same layout as print_statistics,
+ * with the count first and the variance last; the median is left out when
+ * the summary has none. PRINT_STATISTICS calls it when given one argument.
+ *
+ * @param description A read-only pointer to the summary.
+ */
+void STATS_FN(print_description)(
+    const STATS_TYPE(description) *const description);
+
+/**
+ * @brief Print the array values to stdout.
+ *
+ * This function prints all of the values in the given array.
+ *
+ * @param arr A read-only pointer to an array.
+ * @param len A read-only length of the pointed to array.
+ */
+void STATS_FN(print_array)(const STATS_T *const arr, const size_t len);
+
+#undef STATS_TYPE
+#undef STATS_FN
+#undef STATS_CAT
+#undef STATS_CAT_
+#undef STATS_SUFFIX
+#undef STATS_T
+#undef STATS_ACC_T
+#undef STATS_FMT
+#undef STATS_KIND
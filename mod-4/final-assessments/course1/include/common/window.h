@@ -0,0 +1,136 @@
+/******************************************************************************
+ * Copyright (C) 2025 by Michael Torres
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Michael Torres is not liable for any misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file window.h
+ * @brief Statistics over the last samples of a stream.
+ *
+ * A sliding window keeps the last len samples of a stream in a fixed buffer
+ * and updates its statistics as each sample arrives, instead of sorting the
+ * window again: the minimum and maximum come from monotonic deques in O(1)
+ * amortized time, the mean from a running sum in O(1) and the median from two
+ * indexed heaps in O(log len). Nothing is allocated, so a window can be a
+ * static or stack variable on the MSP432.
+ *
+ * @author Michael Torres
+ * @date 10/18/26
+ *
+ */
+#ifndef __WINDOW_H__
+#define __WINDOW_H__
+
+#include <stdint.h>
+
+/* Largest window length; a window takes 15 bytes per sample of this. */
+#ifndef WINDOW_MAX_LEN
+#define WINDOW_MAX_LEN (256u)
+#endif
+
+/**
+ * @brief A double-ended queue of window slots, kept in a ring.
+ */
+typedef struct {
+  uint16_t slots[WINDOW_MAX_LEN];
+  uint16_t head;
+  uint16_t count;
+} window_deque_t;
+
+/**
+ * @brief The state of a sliding window.
+ *
+ * samples is a ring of the last len samples, with next the slot the next
+ * sample replaces. The maximum deque holds the slots of the samples that are
+ * larger than every later sample, oldest first, so the maximum is at its
+ * front; the minimum deque is the same for smaller. heap[0] is a max-heap of
+ * the slots of the lower half of the samples and heap[1] a min-heap of the
+ * upper half, with side and position giving each slot's place in them.
+ */
+typedef struct {
+  int32_t samples[WINDOW_MAX_LEN];
+  int64_t sum;
+  uint16_t len;
+  uint16_t count;
+  uint16_t next;
+  window_deque_t maximum;
+  window_deque_t minimum;
+  uint16_t heap[2][WINDOW_MAX_LEN];
+  uint16_t heap_count[2];
+  uint8_t side[WINDOW_MAX_LEN];
+  uint16_t position[WINDOW_MAX_LEN];
+} window_t;
+
+/**
+ * @brief Start an empty sliding window.
+ *
+ * @param window A pointer to the window.
+ * @param len The number of samples in a full window; from 1 to
+ *            WINDOW_MAX_LEN.
+ */
+void window_init(window_t *const window, const unsigned int len);
+
+/**
+ * @brief Add a sample to a sliding window.
+ *
+ * Once the window is full the oldest sample leaves it. This takes O(log len)
+ * time, and O(1) amortized for everything but the median.
+ *
+ * @param window A pointer to the window.
+ * @param value The new sample.
+ */
+void window_push(window_t *const window, const int32_t value);
+
+/**
+ * @brief Find the median of the samples in a sliding window.
+ *
+ * For an even number of samples the two middle values are averaged,
+ * truncating towards zero, as find_median does.
+ *
+ * @param window A read-only pointer to a non-empty window.
+ *
+ * @return The median value.
+ */
+int32_t window_median(const window_t *const window);
+
+/**
+ * @brief Find the mean of the samples in a sliding window.
+ *
+ * @param window A read-only pointer to a non-empty window.
+ *
+ * @return The mean value, truncated towards zero.
+ */
+int32_t window_mean(const window_t *const window);
+
+/**
+ * @brief Find the maximum of the samples in a sliding window.
+ *
+ * @param window A read-only pointer to a non-empty window.
+ *
+ * @return The maximum value.
+ */
+int32_t window_maximum(const window_t *const window);
+
+/**
+ * @brief Find the minimum of the samples in a sliding window.
+ *
+ * @param window A read-only pointer to a non-empty window.
+ *
+ * @return The minimum value.
+ */
+int32_t window_minimum(const window_t *const window);
+
+/**
+ * @brief Print the statistics of a sliding window to stdout.
+ *
+ * This function prints in the same layout as print_statistics.
+ *
+ * @param window A read-only pointer to a non-empty window.
+ */
+void print_window(const window_t *const window);
+
+#endif /* __WINDOW_H__ */
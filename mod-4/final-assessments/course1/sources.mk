@@ -17,6 +17,13 @@ SOURCES = src/interrupts_msp432p401r_gcc.c \
 		  src/course1.c \
 		  src/data.c \
 		  src/stats.c \
+		  src/window.c \
+		  src/dataset.c \
+		  src/columns.c \
+		  src/packed.c \
+		  src/search.c \
+		  src/hll.c \
+		  src/bench.c \
 		  src/main.c
 INCLUDES = -Iinclude/common \
 		   -Iinclude/CMSIS \
@@ -26,6 +33,14 @@ SOURCES = src/memory.c \
 		  src/course1.c \
 		  src/data.c \
 		  src/stats.c \
+		  src/window.c \
+		  src/dataset.c \
+		  src/columns.c \
+		  src/packed.c \
+		  src/search.c \
+		  src/extsort.c \
+		  src/hll.c \
+		  src/bench.c \
 		  src/main.c
 INCLUDES = -Iinclude/common
 endif
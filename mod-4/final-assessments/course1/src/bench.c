@@ -0,0 +1,525 @@
+/******************************************************************************
+ * Copyright (C) 2025 by Michael Torres
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Michael Torres is not liable for any misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file bench.c
+ * @brief Benchmarks for the statistics functions.
+ *
+ * @author Michael Torres
+ * @date 10/18/26
+ *
+ */
+#include "bench.h"
+#include "columns.h"
+#include "hll.h"
+#include "memory.h"
+#include "packed.h"
+#include "platform.h"
+#include "search.h"
+#include "stats.h"
+
+#if defined(HOST)
+#include <time.h>
+#define BENCH_UNIT "us"
+#else
+#define BENCH_UNIT "cycles"
+#endif
+
+/**
+ * @brief Read the benchmark clock.
+ *
+ * @return Microseconds of processor time on HOST, core cycles on the MSP432.
+ */
+static uint32_t bench_now(void);
+
+/**
+ * @brief Print one measurement as a table cell.
+ *
+ * @param ticks The measurement, in the units of bench_now.
+ */
+static void bench_report(const uint32_t ticks);
+
+/**
+ * @brief Fill a buffer with pseudo-random bytes.
+ *
+ * The same seed always gives the same bytes, so runs can be compared.
+ *
+ * @param dst Pointer to the buffer
+ * @param length The number of bytes to fill
+ * @param seed A non-zero seed
+ */
+static void bench_fill(uint8_t *const dst, const size_t length, uint32_t seed);
+
+/**
+ * @brief Find a lower bound with a textbook binary search.
+ *
+ * This is the search bench_search measures the others against; it branches on
+ * every comparison.
+ *
+ * @param arr A read-only pointer to a sorted array.
+ * @param len A read-only length of the pointed to array.
+ * @param value The value to look for.
+ *
+ * @return The same index as lower_bound_u32.
+ */
+static unsigned int bench_binary_search(const uint32_t *const arr,
+                                        const unsigned int len,
+                                        const uint32_t value);
+
+/*******************************************************************************
+ Function Definitions
+*******************************************************************************/
+void bench(void) {
+#if defined(MSP432)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+  bench_sort();
+  bench_batch();
+  bench_search();
+  bench_hll();
+  bench_outliers();
+  bench_columns();
+  bench_packed();
+  bench_mode();
+}
+
+// -----------------------------------------------------------------------------
+void bench_sort(void) {
+  PRINTF("\nbench_sort() - " BENCH_UNIT " per sort\n");
+  PRINTF("%12s %12s %12s %12s %12s\n", "len", "radix u16", "quick u16",
+         "radix u32", "quick u32");
+  for (uint32_t len = BENCH_MIN_LEN; len <= BENCH_MAX_LEN; len *= 10) {
+    uint32_t *const data = (uint32_t *)reserve_words(len);
+    if (!data) {
+      PRINTF("%12" PRIu32 " out of memory\n", len);
+      return;
+    }
+    PRINTF("%12" PRIu32, len);
+    for (uint8_t run = 0; run < 4; run++) {
+      const uint8_t is_quick = run % 2;
+      const uint8_t is_wide = run / 2;
+      if (is_quick && len > BENCH_QUICKSORT_MAX_LEN) {
+        PRINTF(" %12s", "-");
+        continue;
+      }
+      bench_fill((uint8_t *)data, len * sizeof(uint32_t), len);
+      const uint32_t start = bench_now();
+      if (is_wide && is_quick)
+        quicksort_u32(data, 0, len - 1);
+      else if (is_wide)
+        radix_sort_u32(data, len);
+      else if (is_quick)
+        quicksort_u16((uint16_t *)data, 0, len - 1);
+      else
+        radix_sort_u16((uint16_t *)data, len);
+      bench_report(bench_now() - start);
+    }
+    free_words(data);
+    PRINTF("\n");
+  }
+}
+
+// -----------------------------------------------------------------------------
+void bench_batch(void) {
+  const size_t bytes = (size_t)BENCH_BATCH_COUNT * BENCH_BATCH_LEN;
+  const size_t words = (bytes + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+  uint8_t *const samples = (uint8_t *)reserve_words(words);
+  // One word per data-set holds its four results.
+  uint8_t *const results = (uint8_t *)reserve_words(BENCH_BATCH_COUNT);
+  if (!samples || !results) {
+    PRINTF("\nbench_batch() - out of memory\n");
+    free_words((const uint32_t *)samples);
+    free_words((const uint32_t *)results);
+    return;
+  }
+  bench_fill(samples, bytes, BENCH_BATCH_COUNT);
+
+  PRINTF("\nbench_batch() - " BENCH_UNIT " for %u data-sets of %u\n",
+         BENCH_BATCH_COUNT, BENCH_BATCH_LEN);
+  PRINTF(" %12s %12s\n", "one by one", "batch");
+  // The same bytes are read as one data-set after another here, and as rows
+  // of one sample from every data-set below.
+  const uint32_t start = bench_now();
+  for (uint32_t set = 0; set < BENCH_BATCH_COUNT; set++) {
+    uint8_t *const result = results + 4 * set;
+    find_statistics(samples + set * BENCH_BATCH_LEN, BENCH_BATCH_LEN, result,
+                    result + 1, result + 2, result + 3);
+  }
+  bench_report(bench_now() - start);
+
+  const uint32_t batch_start = bench_now();
+  find_statistics_batch(samples, BENCH_BATCH_LEN, BENCH_BATCH_COUNT, results,
+                        results + BENCH_BATCH_COUNT,
+                        results + 2 * BENCH_BATCH_COUNT,
+                        results + 3 * BENCH_BATCH_COUNT);
+  bench_report(bench_now() - batch_start);
+  PRINTF("\n");
+  free_words((const uint32_t *)samples);
+  free_words((const uint32_t *)results);
+}
+
+// -----------------------------------------------------------------------------
+void bench_search(void) {
+  uint32_t *const queries = (uint32_t *)reserve_words(BENCH_SEARCH_QUERIES);
+  if (!queries) {
+    PRINTF("\nbench_search() - out of memory\n");
+    return;
+  }
+  PRINTF("\nbench_search() - " BENCH_UNIT " for %u lookups\n",
+         BENCH_SEARCH_QUERIES);
+  PRINTF("%12s %12s %12s %12s\n", "len", "binary", "branchless",
+         "eytzinger");
+  // Keeps the compiler from dropping searches whose results are unused.
+  volatile uint32_t sink = 0;
+  for (uint32_t len = BENCH_SEARCH_MIN_LEN; len <= BENCH_SEARCH_MAX_LEN;
+       len *= 10) {
+    uint32_t *const data = (uint32_t *)reserve_words(len);
+    uint32_t *const tree = (uint32_t *)reserve_words((size_t)len + 1);
+    if (!data || !tree) {
+      PRINTF("%12" PRIu32 " out of memory\n", len);
+      free_words(data);
+      free_words(tree);
+      break;
+    }
+    // Even values from largest to smallest, so half the lookups miss.
+    for (uint32_t i = 0; i < len; i++)
+      data[i] = 2 * (len - 1 - i);
+    eytzinger_layout_u32(data, len, tree);
+    bench_fill((uint8_t *)queries, BENCH_SEARCH_QUERIES * sizeof(uint32_t),
+               len);
+    for (uint32_t i = 0; i < BENCH_SEARCH_QUERIES; i++)
+      queries[i] %= 2 * len;
+
+    PRINTF("%12" PRIu32, len);
+    for (uint8_t run = 0; run < 3; run++) {
+      uint32_t found = 0;
+      const uint32_t start = bench_now();
+      for (uint32_t i = 0; i < BENCH_SEARCH_QUERIES; i++) {
+        if (run == 0)
+          found += bench_binary_search(data, len, queries[i]);
+        else if (run == 1)
+          found += lower_bound_u32(data, len, queries[i]);
+        else
+          found += eytzinger_lower_bound_u32(tree, len, queries[i]);
+      }
+      bench_report(bench_now() - start);
+      sink += found;
+    }
+    PRINTF("\n");
+    free_words(data);
+    free_words(tree);
+  }
+  free_words(queries);
+  (void)sink;
+}
+
+// -----------------------------------------------------------------------------
+void bench_hll(void) {
+  uint32_t *const stream = (uint32_t *)reserve_words(BENCH_HLL_LEN);
+  uint32_t *const sorted = (uint32_t *)reserve_words(BENCH_HLL_LEN);
+  if (!stream || !sorted) {
+    PRINTF("\nbench_hll() - out of memory\n");
+    free_words(stream);
+    free_words(sorted);
+    return;
+  }
+  PRINTF("\nbench_hll() - " BENCH_UNIT " to count %u IDs\n", BENCH_HLL_LEN);
+  PRINTF("%12s %12s %12s %12s %12s\n", "distinct", "hll", "radix sort",
+         "estimate", "error %");
+  for (uint32_t distinct = BENCH_MIN_LEN; distinct <= BENCH_HLL_MAX_DISTINCT;
+       distinct *= 10) {
+    // Multiplying by an odd number keeps the IDs distinct but scatters them.
+    for (uint32_t i = 0; i < BENCH_HLL_LEN; i++)
+      stream[i] = (i % distinct) * 2654435761u;
+    my_memcopy((uint8_t *)stream, (uint8_t *)sorted,
+               BENCH_HLL_LEN * sizeof(uint32_t));
+
+    hll_t hll;
+    if (hll_init(&hll, HLL_DEFAULT_PRECISION) != 0) {
+      PRINTF("%12" PRIu32 " out of memory\n", distinct);
+      break;
+    }
+    PRINTF("%12" PRIu32, distinct);
+    const uint32_t start = bench_now();
+    hll_update_batch(&hll, stream, BENCH_HLL_LEN);
+    const double estimate = hll_estimate(&hll);
+    bench_report(bench_now() - start);
+
+    const uint32_t sort_start = bench_now();
+    radix_sort_u32(sorted, BENCH_HLL_LEN);
+    uint32_t exact = 1;
+    for (uint32_t i = 1; i < BENCH_HLL_LEN; i++)
+      exact += sorted[i] != sorted[i - 1];
+    bench_report(bench_now() - sort_start);
+
+    PRINTF(" %12.0f %12.2f\n", estimate,
+           100.0 * (estimate - (double)exact) / (double)exact);
+    // PRINTF expands to nothing on the MSP432.
+    (void)estimate;
+    hll_free(&hll);
+  }
+  free_words(stream);
+  free_words(sorted);
+}
+
+// -----------------------------------------------------------------------------
+void bench_outliers(void) {
+  const size_t words = BENCH_OUTLIER_MAX_LEN * sizeof(int16_t) / 4;
+  int16_t *const frame = (int16_t *)reserve_words(words);
+  int16_t *const scratch = (int16_t *)reserve_words(words);
+  uint8_t *const mask = (uint8_t *)reserve_words(BENCH_OUTLIER_MAX_LEN / 32);
+  if (!frame || !scratch || !mask) {
+    PRINTF("\nbench_outliers() - out of memory\n");
+    free_words((const uint32_t *)frame);
+    free_words((const uint32_t *)scratch);
+    free_words((const uint32_t *)mask);
+    return;
+  }
+  PRINTF("\nbench_outliers() - " BENCH_UNIT " per frame of 16-bit samples\n");
+  PRINTF("%12s %12s %12s %12s\n", "len", "mad", "iqr", "flagged");
+  for (uint32_t len = BENCH_OUTLIER_MIN_LEN; len <= BENCH_OUTLIER_MAX_LEN;
+       len *= 4) {
+    bench_fill((uint8_t *)frame, len * sizeof(int16_t), len);
+    // Narrow the noise to a tenth of the range, then add a spike every 32.
+    for (uint32_t i = 0; i < len; i++)
+      frame[i] = (int16_t)(frame[i] / 10 + (i % 32 == 0 ? 20000 : 0));
+
+    PRINTF("%12" PRIu32, len);
+    size_t flagged = 0;
+    for (uint8_t run = 0; run < 2; run++) {
+      const uint32_t start = bench_now();
+      for (uint32_t f = 0; f < BENCH_OUTLIER_FRAMES; f++) {
+        if (run == 0)
+          flagged = flag_outliers_mad_s16(frame, len, 3.0f, scratch, mask);
+        else
+          flagged = flag_outliers_iqr_s16(frame, len, 1.5f, scratch, mask);
+      }
+      bench_report((bench_now() - start) / BENCH_OUTLIER_FRAMES);
+    }
+    PRINTF(" %12zu\n", flagged);
+    // PRINTF expands to nothing on the MSP432.
+    (void)flagged;
+  }
+  free_words((const uint32_t *)frame);
+  free_words((const uint32_t *)scratch);
+  free_words((const uint32_t *)mask);
+}
+
+// -----------------------------------------------------------------------------
+void bench_columns(void) {
+  const size_t words = BENCH_COLUMNS_FRAMES;
+  int16_t *const frames = (int16_t *)reserve_words(words);
+  int16_t *const channel = (int16_t *)reserve_words((words + 1) / 2);
+  columns_t table;
+  if (!frames || !channel ||
+      columns_init(&table, DATASET_S16, 2, BENCH_COLUMNS_FRAMES) != 0) {
+    PRINTF("\nbench_columns() - out of memory\n");
+    free_words((const uint32_t *)frames);
+    free_words((const uint32_t *)channel);
+    return;
+  }
+  bench_fill((uint8_t *)frames, words * sizeof(uint32_t), words);
+
+  PRINTF("\nbench_columns() - " BENCH_UNIT " for %u queries of %u frames\n",
+         BENCH_COLUMNS_QUERIES, BENCH_COLUMNS_FRAMES);
+  PRINTF(" %12s %12s %12s\n", "copy out", "split", "columns");
+  // Keeps the compiler from dropping means whose results are unused.
+  volatile int32_t sink = 0;
+  const uint32_t start = bench_now();
+  for (uint32_t query = 0; query < BENCH_COLUMNS_QUERIES; query++) {
+    for (uint32_t c = 0; c < 2; c++) {
+      for (uint32_t i = 0; i < BENCH_COLUMNS_FRAMES; i++)
+        channel[i] = frames[2 * i + c];
+      sink += find_mean_s16(channel, BENCH_COLUMNS_FRAMES);
+    }
+  }
+  bench_report(bench_now() - start);
+
+  const uint32_t split_start = bench_now();
+  columns_ingest(&table, frames, BENCH_COLUMNS_FRAMES);
+  bench_report(bench_now() - split_start);
+
+  const uint32_t query_start = bench_now();
+  for (uint32_t query = 0; query < BENCH_COLUMNS_QUERIES; query++) {
+    for (uint32_t c = 0; c < 2; c++)
+      sink += find_mean_s16((const int16_t *)columns_column(&table, c),
+                            table.len);
+  }
+  bench_report(bench_now() - query_start);
+  PRINTF("\n");
+  columns_free(&table);
+  free_words((const uint32_t *)frames);
+  free_words((const uint32_t *)channel);
+  (void)sink;
+}
+
+// -----------------------------------------------------------------------------
+void bench_packed(void) {
+  const size_t words = BENCH_PACKED_LEN / sizeof(uint32_t);
+  unsigned char *const samples = (unsigned char *)reserve_words(words);
+  uint32_t *const ranges = (uint32_t *)reserve_words(2 * BENCH_PACKED_QUERIES);
+  packed_t packed;
+  if (!samples || !ranges ||
+      packed_init(&packed, BENCH_PACKED_LEN,
+                  packed_bound(BENCH_PACKED_LEN)) != 0) {
+    PRINTF("\nbench_packed() - out of memory\n");
+    free_words((const uint32_t *)samples);
+    free_words(ranges);
+    return;
+  }
+  // Random steps of -2 to 2 from the middle of the range.
+  bench_fill(samples, BENCH_PACKED_LEN, BENCH_PACKED_LEN);
+  unsigned char level = 128;
+  for (uint32_t i = 0; i < BENCH_PACKED_LEN; i++) {
+    level = (unsigned char)(level + samples[i] % 5 - 2);
+    samples[i] = level;
+  }
+  bench_fill((uint8_t *)ranges, 2 * BENCH_PACKED_QUERIES * sizeof(uint32_t),
+             BENCH_PACKED_QUERIES);
+  for (uint32_t q = 0; q < BENCH_PACKED_QUERIES; q++) {
+    ranges[2 * q] %= BENCH_PACKED_LEN;
+    ranges[2 * q + 1] =
+        1 + ranges[2 * q + 1] % (BENCH_PACKED_LEN - ranges[2 * q]);
+  }
+  packed_encode(&packed, samples, BENCH_PACKED_LEN);
+  const size_t blocks =
+      (BENCH_PACKED_LEN + PACKED_BLOCK_LEN - 1) / PACKED_BLOCK_LEN;
+  const size_t bytes = blocks * sizeof(packed_block_t) + packed.payload_len;
+
+  PRINTF("\nbench_packed() - " BENCH_UNIT " for %u ranges of %u samples\n",
+         BENCH_PACKED_QUERIES, BENCH_PACKED_LEN);
+  PRINTF(" %12s %12s %12s\n", "size %", "raw", "packed");
+  PRINTF(" %12.1f", 100.0 * (double)bytes / BENCH_PACKED_LEN);
+  // Keeps the compiler from dropping statistics whose results are unused.
+  volatile uint32_t sink = 0;
+  const uint32_t start = bench_now();
+  for (uint32_t q = 0; q < BENCH_PACKED_QUERIES; q++) {
+    const description_t description =
+        describe(samples + ranges[2 * q], ranges[2 * q + 1], NULL);
+    sink += description.maximum + description.minimum + description.mean;
+  }
+  bench_report(bench_now() - start);
+
+  const uint32_t packed_start = bench_now();
+  for (uint32_t q = 0; q < BENCH_PACKED_QUERIES; q++) {
+    const size_t first = ranges[2 * q];
+    const size_t count = ranges[2 * q + 1];
+    sink += packed_maximum(&packed, first, count) +
+            packed_minimum(&packed, first, count) +
+            packed_mean(&packed, first, count);
+  }
+  bench_report(bench_now() - packed_start);
+  PRINTF("\n");
+  packed_free(&packed);
+  free_words((const uint32_t *)samples);
+  free_words(ranges);
+  // PRINTF expands to nothing on the MSP432.
+  (void)bytes;
+  (void)sink;
+}
+
+// -----------------------------------------------------------------------------
+void bench_mode(void) {
+  PRINTF("\nbench_mode() - " BENCH_UNIT " per mode of 16-bit samples\n");
+  PRINTF("%12s %12s %12s %12s\n", "len", "sort + scan", "find_mode",
+         "sketch");
+  // Keeps the compiler from dropping modes whose results are unused.
+  volatile uint32_t sink = 0;
+  for (uint32_t len = BENCH_MIN_LEN; len <= BENCH_MODE_MAX_LEN; len *= 10) {
+    uint16_t *const data = (uint16_t *)reserve_words((len + 1) / 2);
+    frequent_u16_t *const sketch =
+        (frequent_u16_t *)reserve_words(sizeof(frequent_u16_t) / 4 + 1);
+    if (!data || !sketch) {
+      PRINTF("%12" PRIu32 " out of memory\n", len);
+      free_words((const uint32_t *)data);
+      free_words((const uint32_t *)sketch);
+      break;
+    }
+    PRINTF("%12" PRIu32, len);
+    for (uint8_t run = 0; run < 3; run++) {
+      bench_fill((uint8_t *)data, len * sizeof(uint16_t), len);
+      // Squaring skews the values towards zero, so one of them is the mode.
+      for (uint32_t i = 0; i < len; i++) {
+        const uint32_t value = data[i] % 4096u;
+        data[i] = (uint16_t)(value * value / 4096u);
+      }
+      const uint32_t start = bench_now();
+      if (run == 0) {
+        sort_array_u16(data, len);
+        uint16_t mode = data[0];
+        uint32_t best = 0;
+        for (uint32_t i = 0, run_len = 0; i < len; i++) {
+          run_len = i > 0 && data[i] == data[i - 1] ? run_len + 1 : 1;
+          if (run_len > best) {
+            best = run_len;
+            mode = data[i];
+          }
+        }
+        sink += mode;
+      } else if (run == 1) {
+        sink += find_mode_u16(data, len);
+      } else {
+        uint16_t mode;
+        size_t count;
+        frequent_init_u16(sketch);
+        frequent_update_u16(sketch, data, len);
+        frequent_top_u16(sketch, &mode, &count, 1);
+        sink += mode;
+      }
+      bench_report(bench_now() - start);
+    }
+    PRINTF("\n");
+    free_words((const uint32_t *)data);
+    free_words((const uint32_t *)sketch);
+  }
+  (void)sink;
+}
+
+// -----------------------------------------------------------------------------
+static uint32_t bench_now(void) {
+#if defined(HOST)
+  return (uint32_t)((uint64_t)clock() * 1000000u / CLOCKS_PER_SEC);
+#else
+  return DWT->CYCCNT;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+static void bench_report(const uint32_t ticks) {
+  PRINTF(" %12" PRIu32, ticks);
+}
+
+// -----------------------------------------------------------------------------
+static void bench_fill(uint8_t *const dst, const size_t length, uint32_t seed) {
+  // xorshift32
+  for (size_t i = 0; i < length; i++) {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    dst[i] = (uint8_t)seed;
+  }
+}
+
+// -----------------------------------------------------------------------------
+static unsigned int bench_binary_search(const uint32_t *const arr,
+                                        const unsigned int len,
+                                        const uint32_t value) {
+  unsigned int low = 0;
+  unsigned int high = len;
+  while (low < high) {
+    const unsigned int middle = low + (high - low) / 2;
+    if (arr[middle] > value)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+  return low;
+}
@@ -0,0 +1,192 @@
+/******************************************************************************
+ * Copyright (C) 2025 by Michael Torres
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Michael Torres is not liable for any misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file columns.c
+ * @brief Multi-channel samples stored one channel after another.
+ *
+ * @author Michael Torres
+ * @date 10/18/26
+ *
+ */
+#include "columns.h"
+#include "memory.h"
+
+#if defined(HOST) && defined(__SSE2__)
+#define HOST_SSE2
+#include <emmintrin.h>
+#endif
+
+/* Frames split per block by columns_ingest; at most 16 KB of frames. */
+#define COLUMNS_BLOCK (256u)
+
+/* Bytes per sample of each dataset_type_t. */
+static const uint8_t columns_sample_size[] = {1, 2, 2, 4, 4, 4};
+
+/**
+ * @brief Copy every step-th sample of a strided run into an array.
+ *
+ * @param dst A pointer to room for count samples.
+ * @param src A read-only pointer to the first sample of the run.
+ * @param step The distance between samples of the run, in samples.
+ * @param count The number of samples to copy.
+ * @param size The size of a sample in bytes: 1, 2 or 4.
+ */
+static void columns_gather(uint8_t *const dst, const uint8_t *const src,
+                           const size_t step, const size_t count,
+                           const size_t size);
+
+#if defined(HOST_SSE2)
+/**
+ * @brief Split two interleaved channels of 16-bit samples.
+ *
+ * @param left A pointer to room for count samples of the first channel.
+ * @param right A pointer to room for count samples of the second channel.
+ * @param src A read-only pointer to count frames.
+ * @param count The number of frames.
+ */
+static void columns_split_stereo_sse2(uint16_t *const left,
+                                      uint16_t *const right,
+                                      const uint16_t *const src,
+                                      const size_t count);
+#endif
+
+/*******************************************************************************
+ Function Definitions
+*******************************************************************************/
+int columns_init(columns_t *const table, const dataset_type_t type,
+                 const unsigned int channels, const size_t capacity) {
+  table->storage = NULL;
+  if (channels == 0 || channels > COLUMNS_MAX_CHANNELS || capacity == 0)
+    return -1;
+  const size_t size = columns_sample_size[type];
+  if (capacity > (SIZE_MAX / 2) / channels / size)
+    return -1;
+  // Round each column up to whole alignment units, and reserve one more unit
+  // so that the first can be moved up onto a boundary.
+  const size_t column_bytes =
+      (capacity * size + COLUMNS_ALIGN - 1) / COLUMNS_ALIGN * COLUMNS_ALIGN;
+  const size_t bytes = channels * column_bytes + COLUMNS_ALIGN;
+  table->storage =
+      (uint8_t *)reserve_words((bytes + sizeof(uint32_t) - 1) /
+                               sizeof(uint32_t));
+  if (table->storage == NULL)
+    return -1;
+
+  const uintptr_t address = (uintptr_t)table->storage;
+  const size_t skip = (COLUMNS_ALIGN - address % COLUMNS_ALIGN) % COLUMNS_ALIGN;
+  uint8_t *const first = table->storage + skip;
+  for (unsigned int c = 0; c < channels; c++)
+    table->columns[c] = first + c * column_bytes;
+  table->len = 0;
+  table->capacity = capacity;
+  table->type = type;
+  table->channels = (uint8_t)channels;
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+void columns_free(columns_t *const table) {
+  free_words((const uint32_t *)table->storage);
+  table->storage = NULL;
+}
+
+// -----------------------------------------------------------------------------
+void columns_clear(columns_t *const table) { table->len = 0; }
+
+// -----------------------------------------------------------------------------
+size_t columns_ingest(columns_t *const table, const void *const interleaved,
+                      const size_t frames) {
+  const size_t room = table->capacity - table->len;
+  const size_t count = frames < room ? frames : room;
+  const size_t size = columns_sample_size[table->type];
+  const size_t channels = table->channels;
+  const size_t frame_bytes = channels * size;
+  const uint8_t *const src = (const uint8_t *)interleaved;
+
+  for (size_t done = 0; done < count; done += COLUMNS_BLOCK) {
+    const size_t block = count - done < COLUMNS_BLOCK ? count - done
+                                                      : COLUMNS_BLOCK;
+    const uint8_t *const frame = src + done * frame_bytes;
+    const size_t offset = (table->len + done) * size;
+#if defined(HOST_SSE2)
+    if (size == 2 && channels == 2) {
+      columns_split_stereo_sse2((uint16_t *)(table->columns[0] + offset),
+                                (uint16_t *)(table->columns[1] + offset),
+                                (const uint16_t *)frame, block);
+      continue;
+    }
+#endif
+    for (size_t c = 0; c < channels; c++)
+      columns_gather(table->columns[c] + offset, frame + c * size, channels,
+                     block, size);
+  }
+  table->len += count;
+  return count;
+}
+
+// -----------------------------------------------------------------------------
+void *columns_column(const columns_t *const table,
+                     const unsigned int channel) {
+  return table->columns[channel];
+}
+
+// -----------------------------------------------------------------------------
+void columns_view(const columns_t *const table, const unsigned int channel,
+                  dataset_t *const view) {
+  dataset_init(view, table->type, table->columns[channel], table->len,
+               DATASET_UNSORTED);
+}
+
+// -----------------------------------------------------------------------------
+static void columns_gather(uint8_t *const dst, const uint8_t *const src,
+                           const size_t step, const size_t count,
+                           const size_t size) {
+  // One loop per size, so that each moves whole samples.
+  if (size == 1) {
+    for (size_t i = 0; i < count; i++)
+      dst[i] = src[i * step];
+  } else if (size == 2) {
+    uint16_t *const to = (uint16_t *)dst;
+    const uint16_t *const from = (const uint16_t *)src;
+    for (size_t i = 0; i < count; i++)
+      to[i] = from[i * step];
+  } else {
+    uint32_t *const to = (uint32_t *)dst;
+    const uint32_t *const from = (const uint32_t *)src;
+    for (size_t i = 0; i < count; i++)
+      to[i] = from[i * step];
+  }
+}
+
+#if defined(HOST_SSE2)
+// -----------------------------------------------------------------------------
+static void columns_split_stereo_sse2(uint16_t *const left,
+                                      uint16_t *const right,
+                                      const uint16_t *const src,
+                                      const size_t count) {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m128i a = _mm_loadu_si128((const __m128i *)(src + 2 * i));
+    const __m128i b = _mm_loadu_si128((const __m128i *)(src + 2 * i + 8));
+    // Sign-extending each half of a frame keeps the pack from saturating, so
+    // the bits come through unchanged for unsigned samples too.
+    const __m128i left_a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+    const __m128i left_b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+    _mm_storeu_si128((__m128i *)(left + i), _mm_packs_epi32(left_a, left_b));
+    _mm_storeu_si128((__m128i *)(right + i),
+                     _mm_packs_epi32(_mm_srai_epi32(a, 16),
+                                     _mm_srai_epi32(b, 16)));
+  }
+  for (; i < count; i++) {
+    left[i] = src[2 * i];
+    right[i] = src[2 * i + 1];
+  }
+}
+#endif
@@ -19,9 +19,12 @@
 
 #include "course1.h"
 #include "data.h"
+#include "hll.h"
 #include "memory.h"
+#include "packed.h"
 #include "platform.h"
 #include "stats.h"
+#include "window.h"
 #include <stdint.h>
 
 int8_t test_data1() {
@@ -290,6 +293,421 @@ int8_t test_reverse() {
   return ret;
 }
 
+int8_t test_variance() {
+  uint8_t i;
+  int64_t sum = 0;
+  int64_t sum_squares = 0;
+  int64_t expected;
+  uint32_t variance;
+  const int16_t set[TEST_VARIANCE_LENGTH] = {
+      -32768, 32767, -32768, 32767, 0, 1, -1, 12345, -12345, 32767, 32767,
+      32767, -32768, -32768, -32768, 100, -200, 300, -400, 500, -600, 700,
+      -800, 900, -1000, 20000, -20000, 25000, -25000, 32000, -32000, 7, -32768};
+
+  PRINTF("test_variance()\n");
+  for (i = 0; i < TEST_VARIANCE_LENGTH; i++) {
+    sum += set[i];
+    sum_squares += (int64_t)set[i] * set[i];
+  }
+  expected = (TEST_VARIANCE_LENGTH * sum_squares - sum * sum) /
+             (TEST_VARIANCE_LENGTH * TEST_VARIANCE_LENGTH);
+
+  variance = find_variance_s16(set, TEST_VARIANCE_LENGTH);
+#ifdef VERBOSE
+  PRINTF("  Expected variance: %lld\n", (long long)expected);
+  PRINTF("  Found variance: %lu\n", (unsigned long)variance);
+#endif
+
+  if ((int64_t)variance != expected) {
+    return TEST_ERROR;
+  }
+  return TEST_NO_ERROR;
+}
+
+int8_t test_select() {
+  uint8_t i;
+  uint8_t len;
+  int8_t ret = TEST_NO_ERROR;
+  uint8_t *sorted;
+  uint8_t *copy;
+  uint8_t set[MEM_SET_SIZE_B] = {
+      0x3F, 0x73, 0x72, 0x33, 0x54, 0x43, 0x72, 0x26, 0x48, 0x63, 0x20,
+      0x66, 0x6F, 0x00, 0x20, 0x33, 0x72, 0x75, 0x74, 0x78, 0x21, 0x4D,
+      0x20, 0x40, 0x20, 0x24, 0x7C, 0x20, 0x24, 0x69, 0x68, 0x54};
+
+  PRINTF("test_select()\n");
+  sorted = (uint8_t *)reserve_words(MEM_SET_SIZE_W);
+  copy = (uint8_t *)reserve_words(MEM_SET_SIZE_W);
+  if (!sorted || !copy) {
+    free_words((uint32_t *)sorted);
+    free_words((uint32_t *)copy);
+    return TEST_ERROR;
+  }
+
+  /* The whole set has an even length and the set less its last an odd one. */
+  for (len = MEM_SET_SIZE_B - 1; len <= MEM_SET_SIZE_B; len++) {
+    my_memcopy(set, sorted, len);
+    sort_array(sorted, len);
+
+    for (i = 0; i < len; i++) {
+      my_memcopy(set, copy, len);
+      if (select_kth(copy, len, i) != sorted[i]) {
+        ret = TEST_ERROR;
+      }
+    }
+
+    my_memcopy(set, copy, len);
+    if (find_median_select(copy, len) != find_median(sorted, len)) {
+      ret = TEST_ERROR;
+    }
+  }
+
+  free_words((uint32_t *)sorted);
+  free_words((uint32_t *)copy);
+  return ret;
+}
+
+int8_t test_quantiles() {
+  uint32_t i;
+  uint8_t decile;
+  int8_t ret = TEST_NO_ERROR;
+  quantile_sketch_t *odd;
+  quantile_sketch_t *even;
+  float value;
+  float error;
+
+  PRINTF("test_quantiles()\n");
+  odd = (quantile_sketch_t *)reserve_words(
+      (sizeof(quantile_sketch_t) + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+  even = (quantile_sketch_t *)reserve_words(
+      (sizeof(quantile_sketch_t) + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+  if (!odd || !even) {
+    free_words((uint32_t *)odd);
+    free_words((uint32_t *)even);
+    return TEST_ERROR;
+  }
+
+  /* Each of 0 to TEST_QUANTILE_COUNT - 1 once, shuffled, split in two. */
+  quantile_sketch_init(odd);
+  quantile_sketch_init(even);
+  for (i = 0; i < TEST_QUANTILE_COUNT; i++) {
+    value = (float)((i * TEST_QUANTILE_STEP) % TEST_QUANTILE_COUNT);
+    quantile_sketch_update(i % 2 ? odd : even, value);
+  }
+  quantile_sketch_merge(even, odd);
+
+  if (quantile_sketch_query(even, 0.0f) != 0.0f ||
+      quantile_sketch_query(even, 1.0f) != TEST_QUANTILE_COUNT - 1) {
+    ret = TEST_ERROR;
+  }
+  /* A sample's value is its rank, so the rank error is read off directly. */
+  for (decile = 1; decile < 10; decile++) {
+    value = quantile_sketch_query(even, decile / 10.0f);
+    error = value - decile * (TEST_QUANTILE_COUNT / 10);
+#ifdef VERBOSE
+    PRINTF("  p%d: %g\n", decile * 10, value);
+#endif
+    if (error > TEST_QUANTILE_ERROR || error < -TEST_QUANTILE_ERROR) {
+      ret = TEST_ERROR;
+    }
+  }
+
+  free_words((uint32_t *)odd);
+  free_words((uint32_t *)even);
+  return ret;
+}
+
+int8_t test_window() {
+  uint8_t i;
+  uint8_t j;
+  uint8_t n;
+  int8_t ret = TEST_NO_ERROR;
+  window_t *window;
+  int32_t stream[TEST_WINDOW_SAMPLES];
+  int32_t sorted[TEST_WINDOW_LENGTH];
+  int64_t sum;
+
+  PRINTF("test_window()\n");
+  window = (window_t *)reserve_words(
+      (sizeof(window_t) + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+  if (!window) {
+    return TEST_ERROR;
+  }
+
+  /* A stream with repeats and both signs, long enough to evict many times. */
+  for (i = 0; i < TEST_WINDOW_SAMPLES; i++) {
+    stream[i] = (int32_t)((i * 37) % 23) - 11;
+  }
+
+  window_init(window, TEST_WINDOW_LENGTH);
+  for (i = 0; i < TEST_WINDOW_SAMPLES; i++) {
+    window_push(window, stream[i]);
+    n = i + 1 < TEST_WINDOW_LENGTH ? i + 1 : TEST_WINDOW_LENGTH;
+    sum = 0;
+    for (j = 0; j < n; j++) {
+      sorted[j] = stream[i + 1 - n + j];
+      sum += sorted[j];
+    }
+    sort_array_s32(sorted, n);
+
+    if (window_median(window) != find_median_s32(sorted, n) ||
+        window_mean(window) != (int32_t)(sum / n) ||
+        window_maximum(window) != sorted[0] ||
+        window_minimum(window) != sorted[n - 1]) {
+      ret = TEST_ERROR;
+    }
+  }
+
+  free_words((uint32_t *)window);
+  return ret;
+}
+
+int8_t test_hll() {
+  uint32_t i;
+  int8_t ret = TEST_NO_ERROR;
+  hll_t *dense;
+  hll_t *sparse;
+  double error;
+  const uint32_t distinct = 8 * HLL_SPARSE_CAPACITY;
+  const uint32_t few = HLL_SPARSE_CAPACITY / 2;
+  const uint32_t overlap = few / 2;
+  const double registers = (double)(1u << HLL_DEFAULT_PRECISION);
+
+  PRINTF("test_hll()\n");
+  dense = (hll_t *)reserve_words((sizeof(hll_t) + sizeof(uint32_t) - 1) /
+                                 sizeof(uint32_t));
+  sparse = (hll_t *)reserve_words((sizeof(hll_t) + sizeof(uint32_t) - 1) /
+                                  sizeof(uint32_t));
+  if (!dense || !sparse || hll_init(dense, HLL_DEFAULT_PRECISION) != 0) {
+    free_words((uint32_t *)dense);
+    free_words((uint32_t *)sparse);
+    return TEST_ERROR;
+  }
+  if (hll_init(sparse, HLL_DEFAULT_PRECISION) != 0) {
+    hll_free(dense);
+    free_words((uint32_t *)dense);
+    free_words((uint32_t *)sparse);
+    return TEST_ERROR;
+  }
+
+  /* Every value twice, so repeats must not count. */
+  for (i = 0; i < 2 * distinct; i++) {
+    hll_update(dense, i % distinct);
+  }
+  /* The last values of the dense stream and as many new ones. */
+  for (i = 0; i < few; i++) {
+    hll_update(sparse, distinct - overlap + i);
+  }
+
+  /* A small stream stays sparse and is counted almost exactly. */
+  error = hll_estimate(sparse) - few;
+  if (sparse->is_dense || error * error > TEST_HLL_SPARSE_ERROR * few * few) {
+    ret = TEST_ERROR;
+  }
+  /* A large one switches to the registers, within TEST_HLL_SIGMAS errors. */
+  error = hll_estimate(dense) - distinct;
+  if (!dense->is_dense || error * error * registers >
+                              TEST_HLL_SIGMAS * (double)distinct * distinct) {
+    ret = TEST_ERROR;
+  }
+  /* Merging the dense sketch into the sparse one counts the union. */
+  if (hll_merge(sparse, dense) != 0 || !sparse->is_dense) {
+    ret = TEST_ERROR;
+  }
+  error = hll_estimate(sparse) - (distinct + few - overlap);
+  if (error * error * registers > TEST_HLL_SIGMAS *
+                                      (double)(distinct + few - overlap) *
+                                      (distinct + few - overlap)) {
+    ret = TEST_ERROR;
+  }
+#ifdef VERBOSE
+  PRINTF("  Union estimate: %g of %lu\n", hll_estimate(sparse),
+         (unsigned long)(distinct + few - overlap));
+#endif
+
+  hll_free(dense);
+  hll_free(sparse);
+  free_words((uint32_t *)dense);
+  free_words((uint32_t *)sparse);
+  return ret;
+}
+
+int8_t test_packed() {
+  uint16_t i;
+  uint16_t j;
+  uint16_t start;
+  uint16_t count;
+  uint8_t maximum;
+  uint8_t minimum;
+  uint32_t sum;
+  int8_t ret = TEST_NO_ERROR;
+  packed_t packed;
+  uint8_t *set;
+  uint8_t *copy;
+  /* Ranges within a block, across block edges and over whole blocks. */
+  const uint16_t ranges[][2] = {{0, TEST_PACKED_LENGTH},
+                                {5, 10},
+                                {10, 100},
+                                {127, 2},
+                                {100, 200},
+                                {130, TEST_PACKED_LENGTH - 130},
+                                {TEST_PACKED_LENGTH - 1, 1}};
+
+  PRINTF("test_packed()\n");
+  set = (uint8_t *)reserve_words(TEST_PACKED_LENGTH / 4);
+  copy = (uint8_t *)reserve_words(TEST_PACKED_LENGTH / 4);
+  if (!set || !copy ||
+      packed_init(&packed, TEST_PACKED_LENGTH,
+                  packed_bound(TEST_PACKED_LENGTH)) != 0) {
+    free_words((uint32_t *)set);
+    free_words((uint32_t *)copy);
+    return TEST_ERROR;
+  }
+
+  /* A constant first block, then small steps with one large jump. */
+  for (i = 0; i < TEST_PACKED_LENGTH; i++) {
+    if (i < PACKED_BLOCK_LEN) {
+      set[i] = 50;
+    } else {
+      set[i] = (uint8_t)(100 + (i * 7) % 13 - 6 + (i >= 300 ? 120 : 0));
+    }
+  }
+
+  if (packed_encode(&packed, set, TEST_PACKED_LENGTH) != 0) {
+    ret = TEST_ERROR;
+  }
+  packed_decode(&packed, 0, TEST_PACKED_LENGTH, copy);
+  for (i = 0; i < TEST_PACKED_LENGTH; i++) {
+    if (copy[i] != set[i]) {
+      ret = TEST_ERROR;
+    }
+  }
+
+  for (i = 0; i < sizeof(ranges) / sizeof(ranges[0]); i++) {
+    start = ranges[i][0];
+    count = ranges[i][1];
+    maximum = 0;
+    minimum = UINT8_MAX;
+    sum = 0;
+    for (j = start; j < start + count; j++) {
+      maximum = set[j] > maximum ? set[j] : maximum;
+      minimum = set[j] < minimum ? set[j] : minimum;
+      sum += set[j];
+    }
+    if (packed_maximum(&packed, start, count) != maximum ||
+        packed_minimum(&packed, start, count) != minimum ||
+        packed_mean(&packed, start, count) != sum / count) {
+      ret = TEST_ERROR;
+    }
+  }
+
+  packed_free(&packed);
+  free_words((uint32_t *)set);
+  free_words((uint32_t *)copy);
+  return ret;
+}
+
+int8_t test_frequent() {
+  uint16_t i;
+  uint16_t j;
+  uint16_t k;
+  uint16_t kind;
+  uint16_t written;
+  uint16_t value;
+  size_t count;
+  int8_t ret = TEST_NO_ERROR;
+  uint16_t *set16;
+  uint8_t *set8;
+  uint16_t values[TEST_FREQUENT_TOP];
+  size_t counts[TEST_FREQUENT_TOP];
+  uint16_t mode;
+
+  PRINTF("test_frequent()\n");
+  set16 = (uint16_t *)reserve_words(TEST_FREQUENT_LENGTH / 2);
+  set8 = (uint8_t *)reserve_words(TEST_FREQUENT_LENGTH / 4);
+  if (!set16 || !set8) {
+    free_words((uint32_t *)set16);
+    free_words((uint32_t *)set8);
+    return TEST_ERROR;
+  }
+
+  /*
+   * Value j appears j % 5 + 1 times, scattered, so every count is tied by
+   * many values. Past 256 distinct values the 16-bit counts must grow their
+   * table, and the 8-bit values wrap onto earlier ones.
+   */
+  k = 0;
+  for (j = 0; j < TEST_FREQUENT_DISTINCT; j++) {
+    for (i = 0; i <= j % 5; i++) {
+      set16[(k * 7) % TEST_FREQUENT_LENGTH] = (uint16_t)(j * 211);
+      k++;
+    }
+  }
+  for (i = 0; i < TEST_FREQUENT_LENGTH; i++) {
+    set8[i] = (uint8_t)set16[i];
+  }
+
+  for (kind = 0; kind < 2; kind++) {
+    if (kind == 0) {
+      uint8_t values8[TEST_FREQUENT_TOP];
+      written = (uint16_t)top_frequent(set8, TEST_FREQUENT_LENGTH, values8,
+                                       counts, TEST_FREQUENT_TOP);
+      for (k = 0; k < written; k++) {
+        values[k] = values8[k];
+      }
+      mode = find_mode(set8, TEST_FREQUENT_LENGTH);
+    } else {
+      written = (uint16_t)top_frequent_u16(set16, TEST_FREQUENT_LENGTH, values,
+                                           counts, TEST_FREQUENT_TOP);
+      mode = find_mode_u16(set16, TEST_FREQUENT_LENGTH);
+    }
+    if (written != TEST_FREQUENT_TOP || mode != values[0]) {
+      ret = TEST_ERROR;
+      continue;
+    }
+
+    /* Each count is exact, in order, largest value first among ties. */
+    for (k = 0; k < TEST_FREQUENT_TOP; k++) {
+      count = 0;
+      for (i = 0; i < TEST_FREQUENT_LENGTH; i++) {
+        count += (kind == 0 ? set8[i] : set16[i]) == values[k];
+      }
+      if (count != counts[k] ||
+          (k > 0 && (counts[k] > counts[k - 1] ||
+                     (counts[k] == counts[k - 1] &&
+                      values[k] >= values[k - 1])))) {
+        ret = TEST_ERROR;
+      }
+    }
+
+    /* No value left out beats the last one written. */
+    for (i = 0; i < TEST_FREQUENT_LENGTH; i++) {
+      value = kind == 0 ? set8[i] : set16[i];
+      for (k = 0; k < TEST_FREQUENT_TOP && values[k] != value; k++) {
+      }
+      if (k < TEST_FREQUENT_TOP) {
+        continue;
+      }
+      count = 0;
+      for (j = 0; j < TEST_FREQUENT_LENGTH; j++) {
+        count += (kind == 0 ? set8[j] : set16[j]) == value;
+      }
+      if (count > counts[TEST_FREQUENT_TOP - 1] ||
+          (count == counts[TEST_FREQUENT_TOP - 1] &&
+           value > values[TEST_FREQUENT_TOP - 1])) {
+        ret = TEST_ERROR;
+      }
+    }
+#ifdef VERBOSE
+    PRINTF("  Mode: %u, %lu times\n", mode, (unsigned long)counts[0]);
+#endif
+  }
+
+  free_words((uint32_t *)set16);
+  free_words((uint32_t *)set8);
+  return ret;
+}
+
 void course1(void) {
   uint8_t i;
   int8_t failed = 0;
@@ -303,6 +721,13 @@ void course1(void) {
   results[5] = test_memcopy();
   results[6] = test_memset();
   results[7] = test_reverse();
+  results[8] = test_variance();
+  results[9] = test_select();
+  results[10] = test_quantiles();
+  results[11] = test_window();
+  results[12] = test_hll();
+  results[13] = test_packed();
+  results[14] = test_frequent();
 
   for (i = 0; i < TESTCOUNT; i++) {
     failed += results[i];
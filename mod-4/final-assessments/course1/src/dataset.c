@@ -0,0 +1,244 @@
+/******************************************************************************
+ * Copyright (C) 2025 by Michael Torres
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Michael Torres is not liable for any misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file dataset.c
+ * @brief A handle to a data-set that remembers what is known about it.
+ *
+ * @author Michael Torres
+ * @date 10/18/26
+ *
+ */
+#include "dataset.h"
+#include "stats.h"
+
+/*
+ * Expands to one case per sample type, each running CALL(type, suffix) with
+ * the suffix of the statistics functions for that type.
+ */
+#define DATASET_CASES(CALL)                                                    \
+  case DATASET_U8:                                                             \
+    CALL(unsigned char, );                                                     \
+    break;                                                                     \
+  case DATASET_U16:                                                            \
+    CALL(uint16_t, _u16);                                                      \
+    break;                                                                     \
+  case DATASET_S16:                                                            \
+    CALL(int16_t, _s16);                                                       \
+    break;                                                                     \
+  case DATASET_U32:                                                            \
+    CALL(uint32_t, _u32);                                                      \
+    break;                                                                     \
+  case DATASET_S32:                                                            \
+    CALL(int32_t, _s32);                                                       \
+    break;                                                                     \
+  case DATASET_F32:                                                            \
+    CALL(float, _f32);                                                         \
+    break
+
+/**
+ * @brief Find and cache the statistics describe gives for a data-set.
+ *
+ * @param dataset A pointer to the handle.
+ */
+static void dataset_summarize(dataset_t *const dataset);
+
+/**
+ * @brief Find the order a data-set is in with one scan.
+ *
+ * @param dataset A read-only pointer to the handle.
+ *
+ * @return DATASET_DESCENDING or DATASET_ASCENDING if every sample is in that
+ *         order (descending if both), otherwise DATASET_UNSORTED.
+ */
+static dataset_order_t dataset_scan_order(const dataset_t *const dataset);
+
+/*******************************************************************************
+ Function Definitions
+*******************************************************************************/
+void dataset_init(dataset_t *const dataset, const dataset_type_t type,
+                  void *const data, const size_t len,
+                  const dataset_order_t order) {
+  dataset->data = data;
+  dataset->len = len;
+  dataset->type = type;
+  dataset->order = order;
+  dataset->cached = 0;
+}
+
+// -----------------------------------------------------------------------------
+double dataset_get(const dataset_t *const dataset, const size_t index) {
+  double value = 0;
+#define GET(T, SUFFIX) value = ((const T *)dataset->data)[index]
+  switch (dataset->type) { DATASET_CASES(GET); }
+#undef GET
+  return value;
+}
+
+// -----------------------------------------------------------------------------
+void dataset_set(dataset_t *const dataset, const size_t index,
+                 const double value) {
+#define SET(T, SUFFIX) ((T *)dataset->data)[index] = (T)value
+  switch (dataset->type) { DATASET_CASES(SET); }
+#undef SET
+  dataset->cached = 0;
+
+  if (dataset->order != DATASET_UNSORTED) {
+    // Compare what was stored, after conversion, with the neighbours.
+    const double stored = dataset_get(dataset, index);
+    const double before =
+        index > 0 ? dataset_get(dataset, index - 1) : stored;
+    const double after =
+        index + 1 < dataset->len ? dataset_get(dataset, index + 1) : stored;
+    const int fits = dataset->order == DATASET_DESCENDING
+                         ? before >= stored && stored >= after
+                         : before <= stored && stored <= after;
+    if (!fits)
+      dataset->order = DATASET_UNSORTED;
+  }
+}
+
+// -----------------------------------------------------------------------------
+void *dataset_modify(dataset_t *const dataset) {
+  dataset->cached = 0;
+  dataset->order = DATASET_UNSORTED;
+  return dataset->data;
+}
+
+// -----------------------------------------------------------------------------
+void dataset_sort(dataset_t *const dataset) {
+  if (dataset->order == DATASET_UNSORTED)
+    dataset->order = dataset_scan_order(dataset);
+  if (dataset->order == DATASET_DESCENDING)
+    return;
+
+  if (dataset->order == DATASET_ASCENDING) {
+#define REVERSE(T, SUFFIX)                                                     \
+  do {                                                                         \
+    T *const arr = (T *)dataset->data;                                         \
+    for (size_t i = 0, j = dataset->len - 1; i < j; i++, j--) {                \
+      const T tmp = arr[i];                                                    \
+      arr[i] = arr[j];                                                         \
+      arr[j] = tmp;                                                            \
+    }                                                                          \
+  } while (0)
+    switch (dataset->type) { DATASET_CASES(REVERSE); }
+#undef REVERSE
+  } else {
+#define SORT(T, SUFFIX) sort_array##SUFFIX((T *)dataset->data, dataset->len)
+    switch (dataset->type) { DATASET_CASES(SORT); }
+#undef SORT
+  }
+  dataset->order = DATASET_DESCENDING;
+}
+
+// -----------------------------------------------------------------------------
+double dataset_median(dataset_t *const dataset) {
+  if (dataset->cached & DATASET_CACHED_MEDIAN)
+    return dataset->median;
+  if (dataset->type == DATASET_U8 && dataset->order == DATASET_UNSORTED) {
+    dataset_summarize(dataset);
+    return dataset->median;
+  }
+
+  dataset_sort(dataset);
+  // The two middle samples are averaged in the sample type, as find_median.
+#define MEDIAN(T, SUFFIX)                                                      \
+  dataset->median = find_median##SUFFIX((const T *)dataset->data, dataset->len)
+  switch (dataset->type) { DATASET_CASES(MEDIAN); }
+#undef MEDIAN
+  dataset->cached |= DATASET_CACHED_MEDIAN;
+  return dataset->median;
+}
+
+// -----------------------------------------------------------------------------
+double dataset_mean(dataset_t *const dataset) {
+  dataset_summarize(dataset);
+  return dataset->mean;
+}
+
+// -----------------------------------------------------------------------------
+double dataset_maximum(dataset_t *const dataset) {
+  if (dataset->order == DATASET_DESCENDING)
+    return dataset_get(dataset, 0);
+  if (dataset->order == DATASET_ASCENDING)
+    return dataset_get(dataset, dataset->len - 1);
+  dataset_summarize(dataset);
+  return dataset->maximum;
+}
+
+// -----------------------------------------------------------------------------
+double dataset_minimum(dataset_t *const dataset) {
+  if (dataset->order == DATASET_DESCENDING)
+    return dataset_get(dataset, dataset->len - 1);
+  if (dataset->order == DATASET_ASCENDING)
+    return dataset_get(dataset, 0);
+  dataset_summarize(dataset);
+  return dataset->minimum;
+}
+
+// -----------------------------------------------------------------------------
+double dataset_variance(dataset_t *const dataset) {
+  dataset_summarize(dataset);
+  return dataset->variance;
+}
+
+// -----------------------------------------------------------------------------
+void print_dataset(dataset_t *const dataset) {
+  PRINTF("\nStatistics\n");
+  PRINTF("%s%10s\n", "What", "Value");
+  PRINTF("%-8s = %zu\n", "Count", dataset->len);
+  PRINTF("%-8s = %g\n", "Median", dataset_median(dataset));
+  PRINTF("%-8s = %g\n", "Mean", dataset_mean(dataset));
+  PRINTF("%-8s = %g\n", "Max", dataset_maximum(dataset));
+  PRINTF("%-8s = %g\n", "Min", dataset_minimum(dataset));
+  PRINTF("%-8s = %g\n", "Variance", dataset_variance(dataset));
+}
+
+// -----------------------------------------------------------------------------
+static void dataset_summarize(dataset_t *const dataset) {
+  if (dataset->cached & DATASET_CACHED_SUMMARY)
+    return;
+#define SUMMARIZE(T, SUFFIX)                                                   \
+  do {                                                                         \
+    const description##SUFFIX##_t description =                                \
+        describe##SUFFIX((const T *)dataset->data, dataset->len, NULL);        \
+    dataset->mean = description.mean;                                          \
+    dataset->maximum = description.maximum;                                    \
+    dataset->minimum = description.minimum;                                    \
+    dataset->variance = description.variance;                                  \
+    if (description.has_median) {                                              \
+      dataset->median = description.median;                                    \
+      dataset->cached |= DATASET_CACHED_MEDIAN;                                \
+    }                                                                          \
+  } while (0)
+  switch (dataset->type) { DATASET_CASES(SUMMARIZE); }
+#undef SUMMARIZE
+  dataset->cached |= DATASET_CACHED_SUMMARY;
+}
+
+// -----------------------------------------------------------------------------
+static dataset_order_t dataset_scan_order(const dataset_t *const dataset) {
+  int descending = 1;
+  int ascending = 1;
+#define SCAN(T, SUFFIX)                                                        \
+  do {                                                                         \
+    const T *const arr = (const T *)dataset->data;                             \
+    for (size_t i = 1; i < dataset->len && (descending || ascending);          \
+         i++) {                                                                \
+      descending = descending && arr[i - 1] >= arr[i];                         \
+      ascending = ascending && arr[i - 1] <= arr[i];                           \
+    }                                                                          \
+  } while (0)
+  switch (dataset->type) { DATASET_CASES(SCAN); }
+#undef SCAN
+  if (descending)
+    return DATASET_DESCENDING;
+  return ascending ? DATASET_ASCENDING : DATASET_UNSORTED;
+}
@@ -0,0 +1,392 @@
+/******************************************************************************
+ * Copyright (C) 2025 by Michael Torres
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Michael Torres is not liable for any misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file extsort.c
+ * @brief Sorting capture files that are larger than memory.
+ *
+ * @author Michael Torres
+ * @date 10/18/26
+ *
+ */
+#include "extsort.h"
+#include "memory.h"
+#include "stats.h"
+#include <stdio.h>
+
+/**
+ * @brief A sorted run in a temporary file.
+ */
+typedef struct {
+  FILE *file;
+  uint64_t len;
+} run_t;
+
+/**
+ * @brief The read side of one run while it is merged.
+ */
+typedef struct {
+  FILE *file;
+  uint64_t left;
+  uint16_t *block;
+  size_t block_len;
+  size_t next;
+  size_t fill;
+} run_reader_t;
+
+/**
+ * @brief Sort the input into runs in temporary files.
+ *
+ * @param input The opened capture file.
+ * @param memory_limit The memory limit, in bytes.
+ * @param runs Where to store a pointer to the new array of runs.
+ * @param run_count Where to store the number of runs.
+ *
+ * @return 0 on success, -1 on failure, with every run closed.
+ */
+static int make_runs(FILE *const input, const size_t memory_limit,
+                     run_t **const runs, size_t *const run_count);
+
+/**
+ * @brief Merge runs into one output file with a loser tree.
+ *
+ * The memory limit is split evenly between one block per run and one block
+ * for the output. The runs are closed, whether or not the merge succeeds.
+ *
+ * @param runs A pointer to the runs to merge.
+ * @param count The number of runs; at least one.
+ * @param output The opened file to write the merged samples to.
+ * @param memory_limit The memory limit, in bytes.
+ * @param stats A pointer to where to store the statistics of the samples, or
+ *              NULL to skip them.
+ *
+ * @return 0 on success, or -1 on failure.
+ */
+static int merge_runs(run_t *const runs, const size_t count,
+                      FILE *const output, const size_t memory_limit,
+                      external_sort_stats_t *const stats);
+
+/**
+ * @brief Make the next sample of a run current, reading a block if needed.
+ *
+ * @param reader A pointer to the run's reader.
+ *
+ * @return 0 if the run has a current sample, 1 if it is used up, or -1 if
+ *         it could not be read.
+ */
+static int run_advance(run_reader_t *const reader);
+
+/**
+ * @brief Say whether one run's current sample goes out before another's.
+ *
+ * A run that is used up loses to every other; ties go to the lower run so
+ * the merge is stable.
+ *
+ * @param readers A read-only pointer to the readers.
+ * @param a The first run.
+ * @param b The second run.
+ *
+ * @return Non-zero if a goes out first.
+ */
+static int run_beats(const run_reader_t *const readers, const unsigned int a,
+                     const unsigned int b);
+
+/**
+ * @brief Play the matches below one node of a loser tree.
+ *
+ * @param tree A pointer to the tree; node n has children 2n and 2n + 1, and
+ *             run i is the leaf count + i.
+ * @param readers A read-only pointer to the readers.
+ * @param count The number of runs.
+ * @param node The node.
+ *
+ * @return The run that wins at the node; the loser is stored in it.
+ */
+static unsigned int tree_build(unsigned int *const tree,
+                               const run_reader_t *const readers,
+                               const unsigned int count,
+                               const unsigned int node);
+
+/**
+ * @brief Close an array of runs and release it.
+ *
+ * @param runs A pointer to the runs.
+ * @param count The number of runs.
+ */
+static void close_runs(run_t *const runs, const size_t count);
+
+/*******************************************************************************
+ Function Definitions
+*******************************************************************************/
+int external_sort_u16(const char *const input, const char *const output,
+                      size_t memory_limit, external_sort_stats_t *const stats) {
+  if (memory_limit == 0)
+    memory_limit = EXTERNAL_SORT_DEFAULT_MEMORY;
+  if (memory_limit < EXTERNAL_SORT_MIN_MEMORY)
+    memory_limit = EXTERNAL_SORT_MIN_MEMORY;
+
+  FILE *const in = fopen(input, "rb");
+  if (!in)
+    return -1;
+  run_t *runs;
+  size_t count;
+  const int made = make_runs(in, memory_limit, &runs, &count);
+  fclose(in);
+  if (made != 0)
+    return -1;
+
+  // Merge groups into longer runs until one block of each fits.
+  const size_t fan_in = memory_limit / EXTERNAL_SORT_MIN_BLOCK - 1;
+  while (count > fan_in) {
+    const size_t merged_count = (count + fan_in - 1) / fan_in;
+    size_t merged = 0;
+    for (size_t first = 0; first < count; first += fan_in) {
+      const size_t group = count - first < fan_in ? count - first : fan_in;
+      FILE *const file = tmpfile();
+      uint64_t len = 0;
+      for (size_t i = 0; i < group; i++)
+        len += runs[first + i].len;
+      // merge_runs closes the group's runs either way.
+      const int failed =
+          !file || merge_runs(runs + first, group, file, memory_limit, NULL);
+      if (failed) {
+        if (file)
+          fclose(file);
+        for (size_t i = file ? first + group : first; i < count; i++)
+          fclose(runs[i].file);
+        // The runs merged so far are at the front.
+        close_runs(runs, merged);
+        return -1;
+      }
+      rewind(file);
+      runs[merged].file = file;
+      runs[merged].len = len;
+      merged++;
+    }
+    count = merged_count;
+  }
+
+  FILE *const out = fopen(output, "wb");
+  if (!out) {
+    close_runs(runs, count);
+    return -1;
+  }
+  int result = count == 0 ? 0 : merge_runs(runs, count, out, memory_limit,
+                                            stats);
+  free(runs);
+  if (fclose(out) != 0)
+    result = -1;
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+void print_external_sort_stats(const external_sort_stats_t *const stats) {
+  PRINTF("\nStatistics\n");
+  PRINTF("%s%10s\n", "What", "Value");
+  PRINTF("%-8s = %" PRIu64 "\n", "Count", stats->count);
+  PRINTF("%-8s = %" PRIu16 "\n", "Median", stats->median);
+  PRINTF("%-8s = %" PRIu16 "\n", "Mean", stats->mean);
+  PRINTF("%-8s = %" PRIu16 "\n", "Max", stats->maximum);
+  PRINTF("%-8s = %" PRIu16 "\n", "Min", stats->minimum);
+}
+
+// -----------------------------------------------------------------------------
+static int make_runs(FILE *const input, const size_t memory_limit,
+                     run_t **const runs, size_t *const run_count) {
+  // sort_array takes as much scratch again as the run it sorts.
+  const size_t chunk_len = memory_limit / (2 * sizeof(uint16_t));
+  uint16_t *const chunk = (uint16_t *)reserve_words((chunk_len + 1) / 2);
+  if (!chunk)
+    return -1;
+
+  run_t *list = NULL;
+  size_t count = 0;
+  size_t capacity = 0;
+  for (;;) {
+    const size_t len = fread(chunk, sizeof(uint16_t), chunk_len, input);
+    if (len == 0)
+      break;
+    if (count == capacity) {
+      capacity = capacity ? 2 * capacity : 16;
+      run_t *const grown = realloc(list, capacity * sizeof(run_t));
+      if (!grown)
+        goto fail;
+      list = grown;
+    }
+    FILE *const file = tmpfile();
+    if (!file)
+      goto fail;
+    sort_array_u16(chunk, len);
+    if (fwrite(chunk, sizeof(uint16_t), len, file) != len) {
+      fclose(file);
+      goto fail;
+    }
+    rewind(file);
+    list[count].file = file;
+    list[count].len = len;
+    count++;
+  }
+  if (ferror(input))
+    goto fail;
+
+  free_words((const uint32_t *)chunk);
+  *runs = list;
+  *run_count = count;
+  return 0;
+
+fail:
+  free_words((const uint32_t *)chunk);
+  close_runs(list, count);
+  return -1;
+}
+
+// -----------------------------------------------------------------------------
+static int merge_runs(run_t *const runs, const size_t count,
+                      FILE *const output, const size_t memory_limit,
+                      external_sort_stats_t *const stats) {
+  // An even number of samples per block keeps every block word aligned.
+  const size_t block_len = memory_limit / (count + 1) / sizeof(uint32_t) * 2;
+  uint16_t *const blocks =
+      (uint16_t *)reserve_words((count + 1) * block_len / 2);
+  run_reader_t *const readers = malloc(count * sizeof(run_reader_t));
+  unsigned int *const tree = malloc(count * sizeof(unsigned int));
+  int result = -1;
+  if (!blocks || !readers || !tree)
+    goto done;
+
+  uint64_t total = 0;
+  for (size_t i = 0; i < count; i++) {
+    readers[i].file = runs[i].file;
+    readers[i].left = runs[i].len;
+    readers[i].block = blocks + (i + 1) * block_len;
+    readers[i].block_len = block_len;
+    readers[i].next = 0;
+    readers[i].fill = 0;
+    total += runs[i].len;
+    if (run_advance(&readers[i]) < 0)
+      goto done;
+  }
+  tree[0] = count == 1 ? 0 : tree_build(tree, readers, count, 1);
+
+  // The median is the middle sample, or the mean of the middle two.
+  const uint64_t middle_high = total / 2;
+  const uint64_t middle_low = total % 2 ? middle_high : middle_high - 1;
+  uint32_t middle_sum = 0;
+  uint64_t sum = 0;
+  uint16_t last = 0;
+  uint16_t *const out = blocks;
+  size_t out_fill = 0;
+  for (uint64_t position = 0; position < total; position++) {
+    unsigned int winner = tree[0];
+    run_reader_t *const reader = &readers[winner];
+    const uint16_t value = reader->block[reader->next];
+    last = value;
+    out[out_fill++] = value;
+    if (out_fill == block_len) {
+      if (fwrite(out, sizeof(uint16_t), out_fill, output) != out_fill)
+        goto done;
+      out_fill = 0;
+    }
+    if (stats) {
+      sum += value;
+      if (position == 0)
+        stats->maximum = value;
+      if (position == middle_low)
+        middle_sum += value;
+      if (position == middle_high)
+        middle_sum += value;
+    }
+
+    reader->next++;
+    if (run_advance(reader) < 0)
+      goto done;
+    // Replay the winner's matches from its leaf to the root.
+    for (unsigned int node = (winner + count) / 2; node > 0; node /= 2) {
+      if (run_beats(readers, tree[node], winner)) {
+        const unsigned int loser = winner;
+        winner = tree[node];
+        tree[node] = loser;
+      }
+    }
+    tree[0] = winner;
+  }
+  if (out_fill != 0 &&
+      fwrite(out, sizeof(uint16_t), out_fill, output) != out_fill)
+    goto done;
+
+  if (stats && total != 0) {
+    stats->count = total;
+    stats->sum = sum;
+    stats->minimum = last;
+    stats->median = (uint16_t)(middle_sum / 2);
+    stats->mean = (uint16_t)(sum / total);
+  }
+  result = 0;
+
+done:
+  if (blocks)
+    free_words((const uint32_t *)blocks);
+  free(readers);
+  free(tree);
+  for (size_t i = 0; i < count; i++)
+    fclose(runs[i].file);
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+static int run_advance(run_reader_t *const reader) {
+  if (reader->next < reader->fill)
+    return 0;
+  if (reader->left == 0)
+    return 1;
+  const size_t want =
+      reader->left < reader->block_len ? (size_t)reader->left : reader->block_len;
+  if (fread(reader->block, sizeof(uint16_t), want, reader->file) != want)
+    return -1;
+  reader->left -= want;
+  reader->next = 0;
+  reader->fill = want;
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+static int run_beats(const run_reader_t *const readers, const unsigned int a,
+                     const unsigned int b) {
+  const int a_done = readers[a].next == readers[a].fill;
+  const int b_done = readers[b].next == readers[b].fill;
+  if (a_done || b_done)
+    return !a_done || (b_done && a < b);
+  const uint16_t a_value = readers[a].block[readers[a].next];
+  const uint16_t b_value = readers[b].block[readers[b].next];
+  return a_value > b_value || (a_value == b_value && a < b);
+}
+
+// -----------------------------------------------------------------------------
+static unsigned int tree_build(unsigned int *const tree,
+                               const run_reader_t *const readers,
+                               const unsigned int count,
+                               const unsigned int node) {
+  if (node >= count)
+    return node - count;
+  const unsigned int left = tree_build(tree, readers, count, 2 * node);
+  const unsigned int right = tree_build(tree, readers, count, 2 * node + 1);
+  if (run_beats(readers, left, right)) {
+    tree[node] = right;
+    return left;
+  }
+  tree[node] = left;
+  return right;
+}
+
+// -----------------------------------------------------------------------------
+static void close_runs(run_t *const runs, const size_t count) {
+  for (size_t i = 0; i < count; i++)
+    fclose(runs[i].file);
+  free(runs);
+}
@@ -0,0 +1,270 @@
+/******************************************************************************
+ * Copyright (C) 2025 by Michael Torres
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Michael Torres is not liable for any misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file hll.c
+ * @brief Estimating the number of distinct values in a stream.
+ *
+ * @author Michael Torres
+ * @date 10/18/26
+ *
+ */
+#include "hll.h"
+#include "memory.h"
+#include "platform.h"
+#include <string.h>
+
+/* Bits of a sparse entry that hold the run length; runs are at most 40. */
+#define HLL_RANK_BITS (6)
+#define HLL_LN2 (0.6931471805599453)
+
+/**
+ * @brief Switch a sparse sketch to its registers.
+ *
+ * @param hll A pointer to a sparse sketch.
+ */
+static void hll_make_dense(hll_t *const hll);
+
+/**
+ * @brief Raise the register a sparse entry falls in to the entry's run length.
+ *
+ * @param hll A pointer to a sketch whose registers are in use.
+ * @param entry A sparse entry.
+ */
+static void hll_fold(hll_t *const hll, const uint32_t entry);
+
+/**
+ * @brief Raise the register a hash falls in to the hash's run length.
+ *
+ * @param hll A pointer to a dense sketch.
+ * @param hash The hash of a value.
+ */
+static void hll_add_dense(hll_t *const hll, const uint64_t hash);
+
+/**
+ * @brief Add a sparse entry to a sketch.
+ *
+ * The entry is folded into the registers if the sketch is dense, or becomes
+ * so because the sparse set is full.
+ *
+ * @param hll A pointer to the sketch.
+ * @param entry A sparse entry.
+ */
+static void hll_add_sparse(hll_t *const hll, const uint32_t entry);
+
+/**
+ * @brief Find the natural logarithm of a positive number.
+ *
+ * The estimates need one logarithm each, and libm is not linked, so it is
+ * found from the binary exponent and a short atanh series.
+ *
+ * @param value A positive number.
+ *
+ * @return Its natural logarithm.
+ */
+static double hll_log(double value);
+
+/*******************************************************************************
+ Function Definitions
+*******************************************************************************/
+int hll_init(hll_t *const hll, const unsigned int precision) {
+  hll->registers = NULL;
+  if (precision < HLL_MIN_PRECISION || precision > HLL_MAX_PRECISION)
+    return -1;
+  const size_t words = ((size_t)1 << precision) / sizeof(uint32_t);
+  hll->registers = (uint8_t *)reserve_words(words);
+  if (hll->registers == NULL)
+    return -1;
+  memset(hll->sparse, 0, sizeof(hll->sparse));
+  hll->sparse_len = 0;
+  hll->precision = (uint8_t)precision;
+  hll->is_dense = 0;
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+void hll_free(hll_t *const hll) {
+  free_words((const uint32_t *)hll->registers);
+  hll->registers = NULL;
+}
+
+// -----------------------------------------------------------------------------
+uint64_t hll_hash(const uint32_t value) {
+  uint64_t hash = value + 0x9E3779B97F4A7C15u;
+  hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9u;
+  hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBu;
+  return hash ^ (hash >> 31);
+}
+
+// -----------------------------------------------------------------------------
+void hll_update(hll_t *const hll, const uint32_t value) {
+  const uint64_t hash = hll_hash(value);
+  if (hll->is_dense) {
+    hll_add_dense(hll, hash);
+    return;
+  }
+  // A guard bit caps the run at the 39 bits below the index.
+  const uint64_t rest =
+      hash << HLL_SPARSE_PRECISION | (uint64_t)1 << (HLL_SPARSE_PRECISION - 1);
+  const uint32_t index = (uint32_t)(hash >> (64 - HLL_SPARSE_PRECISION));
+  const uint32_t rank = (uint32_t)__builtin_clzll(rest) + 1;
+  hll_add_sparse(hll, index << HLL_RANK_BITS | rank);
+}
+
+// -----------------------------------------------------------------------------
+void hll_update_batch(hll_t *const hll, const uint32_t *const values,
+                      const size_t len) {
+  size_t i = 0;
+  for (; i < len && !hll->is_dense; i++)
+    hll_update(hll, values[i]);
+  for (; i < len; i++)
+    hll_add_dense(hll, hll_hash(values[i]));
+}
+
+// -----------------------------------------------------------------------------
+int hll_merge(hll_t *const dst, const hll_t *const src) {
+  if (dst->precision != src->precision)
+    return -1;
+  if (!src->is_dense) {
+    for (size_t i = 0; i < HLL_SPARSE_SLOTS; i++)
+      if (src->sparse[i] != 0)
+        hll_add_sparse(dst, src->sparse[i]);
+    return 0;
+  }
+
+  if (!dst->is_dense)
+    hll_make_dense(dst);
+  const size_t count = (size_t)1 << dst->precision;
+  for (size_t i = 0; i < count; i++)
+    if (src->registers[i] > dst->registers[i])
+      dst->registers[i] = src->registers[i];
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+double hll_estimate(const hll_t *const hll) {
+  if (!hll->is_dense) {
+    const double fine = (double)((uint64_t)1 << HLL_SPARSE_PRECISION);
+    return fine * hll_log(fine / (fine - (double)hll->sparse_len));
+  }
+
+  const size_t count = (size_t)1 << hll->precision;
+  const double m = (double)count;
+  double harmonic = 0;
+  size_t zeros = 0;
+  for (size_t i = 0; i < count; i++) {
+    harmonic += 1.0 / (double)((uint64_t)1 << hll->registers[i]);
+    zeros += hll->registers[i] == 0;
+  }
+
+  double alpha = 0.7213 / (1.0 + 1.079 / m);
+  if (count == 16)
+    alpha = 0.673;
+  else if (count == 32)
+    alpha = 0.697;
+  else if (count == 64)
+    alpha = 0.709;
+  const double raw = alpha * m * m / harmonic;
+  // The harmonic mean is biased high while many registers are still empty.
+  if (raw <= 2.5 * m && zeros != 0)
+    return m * hll_log(m / (double)zeros);
+  return raw;
+}
+
+// -----------------------------------------------------------------------------
+void print_hll(const hll_t *const hll) {
+  PRINTF("\nDistinct\n");
+  PRINTF("%s%10s\n", "What", "Value");
+  PRINTF("%-8s = %u\n", "Bits", hll->precision);
+  PRINTF("%-8s = %s\n", "Mode", hll->is_dense ? "dense" : "sparse");
+  PRINTF("%-8s = %.0f\n", "Estimate", hll_estimate(hll));
+}
+
+// -----------------------------------------------------------------------------
+static void hll_make_dense(hll_t *const hll) {
+  memset(hll->registers, 0, (size_t)1 << hll->precision);
+  for (size_t i = 0; i < HLL_SPARSE_SLOTS; i++)
+    if (hll->sparse[i] != 0)
+      hll_fold(hll, hll->sparse[i]);
+  hll->sparse_len = 0;
+  hll->is_dense = 1;
+}
+
+// -----------------------------------------------------------------------------
+static void hll_fold(hll_t *const hll, const uint32_t entry) {
+  const unsigned int shift = HLL_SPARSE_PRECISION - hll->precision;
+  const uint32_t fine = entry >> HLL_RANK_BITS;
+  const uint32_t index = fine >> shift;
+  // The fine index bits below the register index start the run; if they are
+  // all zero the run carries on into the entry's own run.
+  const uint32_t low = fine & ((UINT32_C(1) << shift) - 1);
+  const uint8_t rank =
+      low ? (uint8_t)(__builtin_clz(low) - (32 - shift) + 1)
+          : (uint8_t)(shift + (entry & ((1u << HLL_RANK_BITS) - 1)));
+  if (rank > hll->registers[index])
+    hll->registers[index] = rank;
+}
+
+// -----------------------------------------------------------------------------
+static void hll_add_dense(hll_t *const hll, const uint64_t hash) {
+  const unsigned int precision = hll->precision;
+  const size_t index = (size_t)(hash >> (64 - precision));
+  const uint64_t rest = hash << precision | (uint64_t)1 << (precision - 1);
+  const uint8_t rank = (uint8_t)(__builtin_clzll(rest) + 1);
+  if (rank > hll->registers[index])
+    hll->registers[index] = rank;
+}
+
+// -----------------------------------------------------------------------------
+static void hll_add_sparse(hll_t *const hll, const uint32_t entry) {
+  if (!hll->is_dense) {
+    const uint32_t index = entry >> HLL_RANK_BITS;
+    // The fine index is already hash bits, so its low bits pick the slot.
+    size_t slot = index & (HLL_SPARSE_SLOTS - 1);
+    while (hll->sparse[slot] != 0 &&
+           hll->sparse[slot] >> HLL_RANK_BITS != index)
+      slot = (slot + 1) & (HLL_SPARSE_SLOTS - 1);
+    if (hll->sparse[slot] != 0) {
+      if (entry > hll->sparse[slot])
+        hll->sparse[slot] = entry;
+      return;
+    }
+    if (hll->sparse_len < HLL_SPARSE_CAPACITY) {
+      hll->sparse[slot] = entry;
+      hll->sparse_len++;
+      return;
+    }
+    hll_make_dense(hll);
+  }
+
+  hll_fold(hll, entry);
+}
+
+// -----------------------------------------------------------------------------
+static double hll_log(double value) {
+  int exponent = 0;
+  while (value >= 2) {
+    value /= 2;
+    exponent++;
+  }
+  while (value < 1) {
+    value *= 2;
+    exponent--;
+  }
+  // ln(value) = 2 atanh(s) with s at most 1/3, so 16 terms reach 1e-16.
+  const double s = (value - 1) / (value + 1);
+  const double s2 = s * s;
+  double power = s;
+  double series = 0;
+  for (int k = 1; k < 32; k += 2) {
+    series += power / k;
+    power *= s2;
+  }
+  return 2 * series + exponent * HLL_LN2;
+}
@@ -23,6 +23,7 @@
 #include "memory.h"
 #include "platform.h"
 #include "course1.h"
+#include "bench.h"
 
 #define MAX_LENGTH (10)
 char buffer[MAX_LENGTH];
@@ -33,5 +34,9 @@ int main(void) {
   course1();
 #endif
 
+#if defined(BENCH)
+  bench();
+#endif
+
   return 0;
 }
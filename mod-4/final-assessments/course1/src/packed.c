@@ -0,0 +1,316 @@
+/******************************************************************************
+ * Copyright (C) 2025 by Michael Torres
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Michael Torres is not liable for any misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file packed.c
+ * @brief Compressed storage of 8-bit samples, with statistics on the blocks.
+ *
+ * @author Michael Torres
+ * @date 10/18/26
+ *
+ */
+#include "packed.h"
+#include "memory.h"
+#include "platform.h"
+#include <string.h>
+
+/**
+ * @brief Find the number of samples in a block.
+ *
+ * @param packed A read-only pointer to the storage.
+ * @param block The index of the block.
+ *
+ * @return PACKED_BLOCK_LEN, or fewer for the last block.
+ */
+static size_t packed_block_len(const packed_t *const packed,
+                               const size_t block);
+
+/**
+ * @brief Decompress the first samples of a block.
+ *
+ * @param packed A read-only pointer to the storage.
+ * @param block A read-only pointer to the block's header.
+ * @param end The number of samples to decompress; non-zero, and at most the
+ *            block's length.
+ * @param dst A pointer to room for end samples.
+ */
+static void packed_unpack(const packed_t *const packed,
+                          const packed_block_t *const block, const size_t end,
+                          unsigned char *const dst);
+
+/**
+ * @brief Find the minimum, maximum and sum of a range of samples.
+ *
+ * Blocks the range covers whole are read from their headers; blocks that
+ * never change are read from their first sample; only the rest are
+ * decompressed, and only as far as the range reaches into them.
+ *
+ * @param packed A read-only pointer to the storage.
+ * @param start The index of the first sample of the range.
+ * @param count The number of samples; non-zero.
+ * @param minimum Where the minimum is stored.
+ * @param maximum Where the maximum is stored.
+ * @param sum Where the sum is stored.
+ */
+static void packed_scan(const packed_t *const packed, const size_t start,
+                        const size_t count, unsigned char *const minimum,
+                        unsigned char *const maximum, uint64_t *const sum);
+
+/*******************************************************************************
+ Function Definitions
+*******************************************************************************/
+size_t packed_bound(const size_t len) {
+  // Every step but each block's first sample takes at most a byte.
+  return len - (len + PACKED_BLOCK_LEN - 1) / PACKED_BLOCK_LEN;
+}
+
+// -----------------------------------------------------------------------------
+int packed_init(packed_t *const packed, const size_t capacity,
+                const size_t payload_bytes) {
+  packed->blocks = NULL;
+  packed->payload = NULL;
+  if (capacity == 0)
+    return -1;
+  const size_t blocks = (capacity + PACKED_BLOCK_LEN - 1) / PACKED_BLOCK_LEN;
+  packed->blocks = (packed_block_t *)reserve_words(
+      (blocks * sizeof(packed_block_t) + sizeof(uint32_t) - 1) /
+      sizeof(uint32_t));
+  // One word more, so that a payload of no bytes still has an address.
+  packed->payload = (uint8_t *)reserve_words(
+      (payload_bytes + sizeof(uint32_t) - 1) / sizeof(uint32_t) + 1);
+  if (packed->blocks == NULL || packed->payload == NULL) {
+    packed_free(packed);
+    return -1;
+  }
+  packed->len = 0;
+  packed->capacity = capacity;
+  packed->payload_len = 0;
+  packed->payload_capacity = payload_bytes;
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+void packed_free(packed_t *const packed) {
+  free_words((const uint32_t *)packed->blocks);
+  free_words((const uint32_t *)packed->payload);
+  packed->blocks = NULL;
+  packed->payload = NULL;
+}
+
+// -----------------------------------------------------------------------------
+int packed_encode(packed_t *const packed, const unsigned char *const arr,
+                  const size_t len) {
+  packed->len = 0;
+  packed->payload_len = 0;
+  if (len > packed->capacity)
+    return -1;
+
+  size_t offset = 0;
+  for (size_t start = 0, b = 0; start < len; start += PACKED_BLOCK_LEN, b++) {
+    const unsigned char *const samples = arr + start;
+    const size_t n = len - start < PACKED_BLOCK_LEN ? len - start
+                                                    : PACKED_BLOCK_LEN;
+    packed_block_t *const block = &packed->blocks[b];
+    unsigned char minimum = samples[0];
+    unsigned char maximum = samples[0];
+    unsigned int sum = samples[0];
+    unsigned int steps = 0;
+    for (size_t i = 1; i < n; i++) {
+      const int8_t step = (int8_t)(samples[i] - samples[i - 1]);
+      // Zigzag: 0, -1, 1, -2, ... become 0, 1, 2, 3, ...
+      steps |= (uint8_t)((uint8_t)step << 1 ^ (uint8_t)(step >> 7));
+      if (samples[i] < minimum)
+        minimum = samples[i];
+      if (samples[i] > maximum)
+        maximum = samples[i];
+      sum += samples[i];
+    }
+    const unsigned int bits = steps ? 32 - (unsigned int)__builtin_clz(steps)
+                                    : 0;
+    const size_t bytes = ((n - 1) * bits + 7) / 8;
+    if (offset + bytes > packed->payload_capacity)
+      return -1;
+
+    block->offset = (uint32_t)offset;
+    block->sum = (uint16_t)sum;
+    block->first = samples[0];
+    block->minimum = minimum;
+    block->maximum = maximum;
+    block->bits = (uint8_t)bits;
+    // Steps go in lowest bits first, each byte written once it fills.
+    uint8_t *out = packed->payload + offset;
+    uint32_t buffer = 0;
+    unsigned int filled = 0;
+    for (size_t i = 1; i < n && bits != 0; i++) {
+      const int8_t step = (int8_t)(samples[i] - samples[i - 1]);
+      const uint8_t folded = (uint8_t)((uint8_t)step << 1 ^
+                                       (uint8_t)(step >> 7));
+      buffer |= (uint32_t)folded << filled;
+      filled += bits;
+      while (filled >= 8) {
+        *out++ = (uint8_t)buffer;
+        buffer >>= 8;
+        filled -= 8;
+      }
+    }
+    if (filled != 0)
+      *out = (uint8_t)buffer;
+    offset += bytes;
+  }
+  packed->len = len;
+  packed->payload_len = offset;
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+void packed_decode(const packed_t *const packed, const size_t start,
+                   const size_t count, unsigned char *const dst) {
+  unsigned char samples[PACKED_BLOCK_LEN];
+  const size_t end = start + count;
+  size_t index = start;
+  while (index < end) {
+    const size_t b = index / PACKED_BLOCK_LEN;
+    const size_t base = b * PACKED_BLOCK_LEN;
+    const size_t low = index - base;
+    const size_t high = end - base < PACKED_BLOCK_LEN ? end - base
+                                                      : PACKED_BLOCK_LEN;
+    unsigned char *const to = dst + (index - start);
+    if (low == 0) {
+      packed_unpack(packed, &packed->blocks[b], high, to);
+    } else {
+      packed_unpack(packed, &packed->blocks[b], high, samples);
+      my_memcopy(samples + low, to, high - low);
+    }
+    index = base + high;
+  }
+}
+
+// -----------------------------------------------------------------------------
+unsigned char packed_maximum(const packed_t *const packed, const size_t start,
+                             const size_t count) {
+  unsigned char minimum, maximum;
+  uint64_t sum;
+  packed_scan(packed, start, count, &minimum, &maximum, &sum);
+  return maximum;
+}
+
+// -----------------------------------------------------------------------------
+unsigned char packed_minimum(const packed_t *const packed, const size_t start,
+                             const size_t count) {
+  unsigned char minimum, maximum;
+  uint64_t sum;
+  packed_scan(packed, start, count, &minimum, &maximum, &sum);
+  return minimum;
+}
+
+// -----------------------------------------------------------------------------
+unsigned char packed_mean(const packed_t *const packed, const size_t start,
+                          const size_t count) {
+  unsigned char minimum, maximum;
+  uint64_t sum;
+  packed_scan(packed, start, count, &minimum, &maximum, &sum);
+  return (unsigned char)(sum / count);
+}
+
+// -----------------------------------------------------------------------------
+void print_packed(const packed_t *const packed) {
+  const size_t blocks = (packed->len + PACKED_BLOCK_LEN - 1) / PACKED_BLOCK_LEN;
+  const size_t bytes = blocks * sizeof(packed_block_t) + packed->payload_len;
+  PRINTF("\nPacked\n");
+  PRINTF("%s%10s\n", "What", "Value");
+  PRINTF("%-8s = %zu\n", "Samples", packed->len);
+  PRINTF("%-8s = %zu\n", "Blocks", blocks);
+  PRINTF("%-8s = %zu\n", "Bytes", bytes);
+  PRINTF("%-8s = %.1f%%\n", "Ratio",
+         packed->len ? 100.0 * (double)bytes / (double)packed->len : 0.0);
+  // PRINTF expands to nothing on the MSP432.
+  (void)bytes;
+}
+
+// -----------------------------------------------------------------------------
+static size_t packed_block_len(const packed_t *const packed,
+                               const size_t block) {
+  const size_t rest = packed->len - block * PACKED_BLOCK_LEN;
+  return rest < PACKED_BLOCK_LEN ? rest : PACKED_BLOCK_LEN;
+}
+
+// -----------------------------------------------------------------------------
+static void packed_unpack(const packed_t *const packed,
+                          const packed_block_t *const block, const size_t end,
+                          unsigned char *const dst) {
+  const unsigned int bits = block->bits;
+  if (bits == 0) {
+    memset(dst, block->first, end);
+    return;
+  }
+  const uint8_t *in = packed->payload + block->offset;
+  const uint32_t mask = (UINT32_C(1) << bits) - 1;
+  uint32_t buffer = 0;
+  unsigned int filled = 0;
+  unsigned char sample = block->first;
+  dst[0] = sample;
+  for (size_t i = 1; i < end; i++) {
+    if (filled < bits) {
+      buffer |= (uint32_t)*in++ << filled;
+      filled += 8;
+    }
+    const uint8_t folded = (uint8_t)(buffer & mask);
+    buffer >>= bits;
+    filled -= bits;
+    // Unfold the zigzag; the sum wraps the same way the difference did.
+    sample = (unsigned char)(sample + ((folded >> 1) ^ -(folded & 1u)));
+    dst[i] = sample;
+  }
+}
+
+// -----------------------------------------------------------------------------
+static void packed_scan(const packed_t *const packed, const size_t start,
+                        const size_t count, unsigned char *const minimum,
+                        unsigned char *const maximum, uint64_t *const sum) {
+  unsigned char samples[PACKED_BLOCK_LEN];
+  unsigned char low_value = UINT8_MAX;
+  unsigned char high_value = 0;
+  uint64_t total = 0;
+  const size_t end = start + count;
+  size_t index = start;
+  while (index < end) {
+    const size_t b = index / PACKED_BLOCK_LEN;
+    const size_t base = b * PACKED_BLOCK_LEN;
+    const size_t block_len = packed_block_len(packed, b);
+    const size_t low = index - base;
+    const size_t high = end - base < block_len ? end - base : block_len;
+    const packed_block_t *const block = &packed->blocks[b];
+    if (low == 0 && high == block_len) {
+      if (block->minimum < low_value)
+        low_value = block->minimum;
+      if (block->maximum > high_value)
+        high_value = block->maximum;
+      total += block->sum;
+    } else if (block->bits == 0) {
+      if (block->first < low_value)
+        low_value = block->first;
+      if (block->first > high_value)
+        high_value = block->first;
+      total += (uint64_t)block->first * (high - low);
+    } else {
+      packed_unpack(packed, block, high, samples);
+      for (size_t i = low; i < high; i++) {
+        if (samples[i] < low_value)
+          low_value = samples[i];
+        if (samples[i] > high_value)
+          high_value = samples[i];
+        total += samples[i];
+      }
+    }
+    index = base + high;
+  }
+  *minimum = low_value;
+  *maximum = high_value;
+  *sum = total;
+}
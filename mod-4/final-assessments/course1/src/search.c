@@ -0,0 +1,45 @@
+/******************************************************************************
+ * Copyright (C) 2025 by Michael Torres
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Michael Torres is not liable for any misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file search.c
+ * @brief Searching arrays that have been through sort_array.
+ *
+ * @author Michael Torres
+ * @date 10/18/26
+ *
+ */
+#include "search.h"
+
+/*******************************************************************************
+ Function Definitions
+*******************************************************************************/
+#define SEARCH_SUFFIX
+#define SEARCH_T unsigned char
+#include "search_template.inc"
+
+#define SEARCH_SUFFIX _u16
+#define SEARCH_T uint16_t
+#include "search_template.inc"
+
+#define SEARCH_SUFFIX _s16
+#define SEARCH_T int16_t
+#include "search_template.inc"
+
+#define SEARCH_SUFFIX _u32
+#define SEARCH_T uint32_t
+#include "search_template.inc"
+
+#define SEARCH_SUFFIX _s32
+#define SEARCH_T int32_t
+#include "search_template.inc"
+
+#define SEARCH_SUFFIX _f32
+#define SEARCH_T float
+#include "search_template.inc"
@@ -13,7 +13,9 @@
  * @brief The program file to calculate statistics.
  *
  * This file is the "main" file for this project. It holds both the main
- * function along with the implementations of the headers in stats.h.
+ * function along with the implementations of the headers in stats.h. The
+ * per-sample functions live in stats_template.inc, which is included once for
+ * each sample type declared in stats.h.
  *
  * @author Michael Torres
  * @date 5/15/25
@@ -21,107 +23,1850 @@
  */
 
 #include "stats.h"
+#include "memory.h"
+#include <string.h>
+
+#if defined(HOST)
+#include <pthread.h>
+#include <unistd.h>
+#endif
+/* The SIMD paths are HOST only, where x86-64 always has SSE2. */
+#if defined(HOST) && defined(__SSE2__)
+#define HOST_SSE2
+#include <emmintrin.h>
+#endif
 
 /* Size of the Data Set */
 #define SIZE (40)
 
+/*
+ * Radix digit width for 32-bit keys. 11 bits needs three passes instead of
+ * four, but its 24KB of counters is too much stack for the MSP432.
+ */
+#if defined(HOST)
+#define RADIX_BITS_32 (11)
+#else
+#define RADIX_BITS_32 (8)
+#endif
+
+/* Sample values taken per bucket when choosing sample_sort's splitters. */
+#define SAMPLE_SORT_OVERSAMPLING (64)
+
+/* Width in characters of the longest bar print_histogram draws. */
+#define HISTOGRAM_BAR_WIDTH (40)
+
+/* Ratio of the standard deviation to the median absolute deviation of normal
+ * data, by which flag_outliers_mad scales MAD. */
+#define MAD_NORMAL_SCALE (1.4826)
+
+/* Bits of slot index top_frequent's count table starts with. */
+#define COUNT_TABLE_MIN_BITS (8u)
+
+/**
+ * @brief The work and result of one slice of a (possibly parallel) pass.
+ */
+typedef struct {
+  const unsigned char *arr;
+  size_t len;
+  uint64_t sum;
+  size_t histogram[HISTOGRAM_BINS];
+} partial_stats_t;
+
+/**
+ * @brief The work of one slice of a (possibly parallel) group_update.
+ */
+typedef struct {
+  group_table_t *table;
+  const keyed_sample_t *samples;
+  size_t len;
+} group_part_t;
+
+/* Multiplier of the group table's Fibonacci hash: 2^32 / the golden ratio. */
+#define GROUP_HASH_MULTIPLIER (0x9E3779B1u)
+
+/* Number of worker threads; zero means it has not been resolved yet. */
+static unsigned int thread_count = 0;
+
+/**
+ * @brief Find the capacity of one level of a quantile sketch.
+ *
+ * The top level may hold QUANTILE_SKETCH_K samples and each level below it
+ * two thirds of the one above, down to QUANTILE_SKETCH_MIN_LEVEL.
+ *
+ * @param sketch A read-only pointer to the sketch.
+ * @param level The level.
+ *
+ * @return The number of samples the level may hold.
+ */
+static unsigned int quantile_sketch_level_capacity(
+    const quantile_sketch_t *const sketch, const unsigned int level);
+
+/**
+ * @brief Make room in a full quantile sketch by compacting one level.
+ *
+ * @param sketch A pointer to a full sketch.
+ */
+static void quantile_sketch_compress(quantile_sketch_t *const sketch);
+
+/**
+ * @brief Add samples to a given level of a quantile sketch.
+ *
+ * The samples go in as one block, or in as few blocks as the free space
+ * allows, compacting the sketch whenever it is full; each block shifts the
+ * levels below this one once.
+ *
+ * @param sketch A pointer to the sketch.
+ * @param level The level; levels are added up to it if need be.
+ * @param values A read-only pointer to the samples.
+ * @param count The number of samples.
+ */
+static void quantile_sketch_insert(quantile_sketch_t *const sketch,
+                                   const unsigned int level,
+                                   const float *const values,
+                                   const unsigned int count);
+
+/**
+ * @brief Sort one level of a quantile sketch, from largest to smallest.
+ *
+ * Levels up to SORT_NETWORK_MAX_LEN samples go through sort_network and
+ * longer ones are heap sorted in place, so that neither reserves memory.
+ *
+ * @param items A pointer to the level's samples.
+ * @param len The number of samples.
+ */
+static void quantile_sketch_sort(float *const items, const unsigned int len);
+
+/**
+ * @brief Sum an array of 16-bit samples and their squares.
+ *
+ * @param arr A read-only pointer to an array.
+ * @param len A read-only length of the pointed to array.
+ * @param sum A pointer to where to store the sum of the samples.
+ * @param sum_squares A pointer to where to store the sum of their squares.
+ */
+static void sum_squares_s16(const int16_t *const arr, const size_t len,
+                            int64_t *const sum, uint64_t *const sum_squares);
+
+/*
+ * 16-bit samples sum_samples adds into a 32-bit block sum before moving it to
+ * the 64-bit total; 2^16 samples of at most 2^16 in magnitude fit.
+ */
+#define SUM_BLOCK_16 ((size_t)1 << 16)
+/* Bytes sum_bytes adds into a 16-bit sum; 257 * 255 = 65535. */
+#define SUM_BLOCK_8 (257u)
+
+/**
+ * @brief Sum an array of 8-bit samples into 64 bits.
+ *
+ * The samples are summed in blocks of SUM_BLOCK_8 into a 16-bit sum, which
+ * the compiler can keep in vector lanes, and each block is added to the
+ * 64-bit total. On HOST with SSE2 each PSADBW sums 16 samples into two 64-bit
+ * lanes, and on the MSP432 each USADA8 adds four samples to a 32-bit sum,
+ * which is moved to the 64-bit one every 2^22 words.
+ *
+ * @param arr A read-only pointer to an array.
+ * @param len A read-only length of the pointed to array.
+ *
+ * @return The sum.
+ */
+static uint64_t sum_bytes(const unsigned char *const arr, const size_t len);
+
+#if defined(HOST_SSE2)
+/* Bytes on either side of sort_network_sse2's working copy of the array. */
+#define SORT_NETWORK_MARGIN (SORT_NETWORK_MAX_LEN / 2)
+
+/**
+ * @brief Run sort_network on 8-bit samples, 16 at a time.
+ *
+ * Every compare-exchange in one step of the network is independent, so each
+ * step is evaluated for a whole vector of positions: a position that is the
+ * upper end of a comparator takes the max of itself and the value d above it,
+ * a lower end takes the min of itself and the value d below it, and every
+ * other position keeps its value. The steps ping-pong between two copies of
+ * the array with margins so the shifted loads never leave the buffers.
+ *
+ * @param arr A pointer to an array.
+ * @param len A read-only length of the pointed to array; at most
+ *            SORT_NETWORK_MAX_LEN.
+ */
+static void sort_network_sse2(unsigned char *const arr, const size_t len);
+
+/**
+ * @brief Run sort_network on 16-bit samples, 8 comparators at a time.
+ *
+ * The samples are copied into signed keys, unsigned ones with their top bit
+ * flipped. A step whose comparators are at least 8 apart is done in place on
+ * vectors: 8 lower ends are loaded with their 8 upper ends, and each lane
+ * that is a comparator of the step keeps the max at its lower end and the min
+ * at its upper end. The rest of a step, and the steps with closer
+ * comparators, are done one comparator at a time.
+ *
+ * @param arr A pointer to an array of 16-bit samples.
+ * @param len A read-only length of the pointed to array; at most
+ *            SORT_NETWORK_MAX_LEN.
+ * @param flip What each sample is XORed with to order it as a signed one.
+ */
+static void sort_network_sse2_16(void *const arr, const size_t len,
+                                 const uint16_t flip);
+
+/**
+ * @brief Run sort_network on 32-bit samples, 4 comparators at a time.
+ *
+ * This is sort_network_sse2_16 with 32-bit keys. SSE2 has no 32-bit integer
+ * min or max, so each pair is swapped with a signed compare and an XOR.
+ * Floats are turned into keys that order as signed integers do, by flipping
+ * all but the sign bit of negative ones, so they take the integer path too.
+ *
+ * @param arr A pointer to an array of 32-bit samples.
+ * @param len A read-only length of the pointed to array; at most
+ *            SORT_NETWORK_MAX_LEN.
+ * @param flip What each integer sample is XORed with to order it as a signed
+ *             one.
+ * @param floats Non-zero if the samples are floats.
+ */
+static void sort_network_sse2_32(void *const arr, const size_t len,
+                                 const uint32_t flip, const int floats);
+#endif
+
+/**
+ * @brief Find the exact part of len times a variance from integer sums.
+ *
+ * len * variance = sum_squares - sum^2 / len. sum^2 can overflow 64 bits, so
+ * with |sum| = q * len + r it is taken as q^2 * len + 2 * q * r + r^2 / len:
+ * the first two terms are subtracted here exactly, and the caller rounds the
+ * last as it needs. That needs q below 2^16, which holds for samples of up to
+ * 16 bits.
+ *
+ * @param magnitude The magnitude of the sum of the samples.
+ * @param sum_squares The sum of the squares of the samples.
+ * @param len The number of samples; must be non-zero.
+ * @param remainder A pointer to where to store r.
+ *
+ * @return sum_squares - q^2 * len - 2 * q * r.
+ */
+static uint64_t spread_from_sums(const uint64_t magnitude,
+                                 const uint64_t sum_squares, const size_t len,
+                                 uint64_t *const remainder);
+
+/**
+ * @brief Find a population variance from exact integer sums.
+ *
+ * Only the r^2 / len term of spread_from_sums is rounded.
+ *
+ * @param magnitude The magnitude of the sum of the samples.
+ * @param sum_squares The sum of the squares of the samples.
+ * @param len The number of samples; must be non-zero.
+ *
+ * @return The variance.
+ */
+static double variance_from_sums(const uint64_t magnitude,
+                                 const uint64_t sum_squares, const size_t len);
+
+/**
+ * @brief Find a population covariance from exact integer sums.
+ *
+ * len * covariance = sum_xy - sum_x * sum_y / len, and the product can
+ * overflow 64 bits. With sum_x = q * len + r and sum_y = q' * len + r', it is
+ * q * sum_y + r * q' + r * r' / len: the first two terms are subtracted
+ * exactly and only the last is rounded, as in variance_from_sums.
+ *
+ * @param sum_x The sum of the first channel.
+ * @param sum_y The sum of the second channel.
+ * @param sum_xy The sum of the products of the pairs.
+ * @param len The number of pairs; must be non-zero and below 2^32.
+ *
+ * @return The covariance.
+ */
+static double covariance_from_sums(const int64_t sum_x, const int64_t sum_y,
+                                   const int64_t sum_xy, const uint64_t len);
+
+/**
+ * @brief Find the square root of a number by Newton's method.
+ *
+ * libm is not linked, and the correlation needs one square root.
+ *
+ * @param value The number.
+ *
+ * @return Its square root, or 0 if it is not positive.
+ */
+static double square_root(const double value);
+
+#if defined(HOST_SSE2)
+/**
+ * @brief The vector part of describe for 16-bit samples.
+ *
+ * Handles the samples in whole groups of eight and leaves the rest to the
+ * caller. Unsigned samples are offset to signed ones so that one signed
+ * multiply-add gives both the pair sums and the pair squares.
+ *
+ * @param arr A read-only pointer to an array.
+ * @param len A read-only length of the pointed to array.
+ * @param is_unsigned Non-zero for uint16_t samples, zero for int16_t.
+ * @param scratch A pointer to copy the samples to, or NULL.
+ * @param minimum Where the minimum is stored, if any samples were handled.
+ * @param maximum Where the maximum is stored, if any samples were handled.
+ * @param sum Where the sum is stored.
+ * @param sum_squares Where the sum of the squares is stored.
+ *
+ * @return The number of samples handled.
+ */
+static size_t describe_16_sse2(const uint16_t *const arr, const size_t len,
+                               const int is_unsigned, uint16_t *const scratch,
+                               int32_t *const minimum, int32_t *const maximum,
+                               int64_t *const sum, uint64_t *const sum_squares);
+#endif
+
+#if defined(HOST_SSE2)
+/**
+ * @brief The vector part of covariance_update_s16.
+ *
+ * Handles the pairs in whole groups of eight, adds their sums to the
+ * accumulator and leaves the rest to the caller.
+ *
+ * @param covariance A pointer to the accumulator.
+ * @param x A read-only pointer to the first channel's samples.
+ * @param y A read-only pointer to the second channel's samples.
+ * @param len A read-only number of pairs.
+ *
+ * @return The number of pairs handled.
+ */
+static size_t covariance_s16_sse2(covariance_s16_t *const covariance,
+                                  const int16_t *const x,
+                                  const int16_t *const y, const size_t len);
+#endif
+
+/**
+ * @brief Find the statistics of one data-set of a batch.
+ *
+ * @param samples A read-only pointer to the data-set's first sample.
+ * @param len A read-only number of samples.
+ * @param stride The distance between the data-set's samples.
+ * @param median Where the median value is stored.
+ * @param mean Where the mean value is stored.
+ * @param max Where the maximum value is stored.
+ * @param min Where the minimum value is stored.
+ */
+static void batch_statistics_one(const unsigned char *const samples,
+                                 const size_t len, const size_t stride,
+                                 unsigned char *const median,
+                                 unsigned char *const mean,
+                                 unsigned char *const max,
+                                 unsigned char *const min);
+
+#if defined(HOST_SSE2)
+/* Data-sets find_statistics_batch does at once, one per byte of a vector. */
+#define BATCH_LANES (16)
+
+/**
+ * @brief Find the statistics of BATCH_LANES data-sets of a batch.
+ *
+ * @param samples A read-only pointer to the first data-set's first sample.
+ * @param len A read-only number of samples; at most SORT_NETWORK_MAX_LEN.
+ * @param stride The distance between the data-sets' rows.
+ * @param median Where the medians are stored.
+ * @param mean Where the means are stored.
+ * @param max Where the maximums are stored.
+ * @param min Where the minimums are stored.
+ */
+static void batch_statistics_sse2(const unsigned char *const samples,
+                                  const size_t len, const size_t stride,
+                                  unsigned char *const median,
+                                  unsigned char *const mean,
+                                  unsigned char *const max,
+                                  unsigned char *const min);
+#endif
+
+/**
+ * @brief Run a piece of work once per part, one part per thread.
+ *
+ * The calling thread takes the first part itself. A worker that fails to start
+ * has its part run on the calling thread as well, so the result never depends
+ * on how many threads the system would give us. Returns once every part is
+ * done. Without threads (the MSP432) the parts are simply run in order.
+ *
+ * @param work The work to run; it is passed a pointer to its part.
+ * @param parts A pointer to the first of count parts.
+ * @param part_size The size in bytes of one part.
+ * @param count The number of parts; at most MAX_THREADS.
+ */
+static void run_parallel(void *(*work)(void *), void *const parts,
+                         const size_t part_size, const unsigned int count);
+
+/**
+ * @brief Accumulate the sum and histogram of one slice.
+ *
+ * This is the body of each worker thread, and is also called directly when
+ * the pass runs serially.
+ *
+ * @param arg A pointer to the partial_stats_t slice to work on.
+ *
+ * @return Always NULL.
+ */
+static void *accumulate_partial(void *arg);
+
+/**
+ * @brief Accumulate the sum and histogram of a whole array.
+ *
+ * Splits the array across the worker threads when it is large enough and the
+ * platform supports it, then merges the partial results into total.
+ *
+ * @param arr A read-only pointer to an array.
+ * @param len A read-only length of the pointed to array.
+ * @param total Where the merged sum and histogram are stored.
+ */
+static void accumulate(const unsigned char *const arr, const size_t len,
+                       partial_stats_t *const total);
+
+/**
+ * @brief Find the value that would be at an index after sort_array.
+ *
+ * @param histogram A histogram of the data-set.
+ * @param index The index in largest-to-smallest order.
+ *
+ * @return The value at that index.
+ */
+static unsigned char histogram_value_at(const size_t *const histogram,
+                                        const size_t index);
+
+/**
+ * @brief Find the accumulator of a channel in a group table.
+ *
+ * @param table A pointer to the table.
+ * @param key The channel id.
+ *
+ * @return The channel's accumulator, an unused one it may claim (count is
+ *         zero), or NULL if the channel is hashed and every slot is taken.
+ */
+static group_stats_t *group_entry(group_table_t *const table,
+                                  const uint32_t key);
+
+/**
+ * @brief Fold an accumulator into the matching one of a group table.
+ *
+ * @param table A pointer to the table.
+ * @param src A read-only pointer to a used accumulator.
+ */
+static void group_fold(group_table_t *const table,
+                       const group_stats_t *const src);
+
+/**
+ * @brief Aggregate one slice of keyed samples into its table.
+ *
+ * This is the body of each worker thread of group_update, and is also called
+ * directly when the batch is done serially.
+ *
+ * @param arg A pointer to the group_part_t slice to work on.
+ *
+ * @return Always NULL.
+ */
+static void *group_update_partial(void *arg);
+
+/**
+ * @brief Add to the count of one slot of a histogram.
+ *
+ * @param histogram A pointer to the histogram.
+ * @param slot 0 for below, 1 + a bin, or bins + 1 for above.
+ * @param count The number of samples to add.
+ */
+static void histogram_tally(histogram_t *const histogram, const size_t slot,
+                            const size_t count);
+
+/**
+ * @brief Find an edge of a histogram's bins.
+ *
+ * @param histogram A read-only pointer to the histogram.
+ * @param index The edge, from 0 for the first bin's lower edge to bins.
+ *
+ * @return The edge.
+ */
+static double histogram_edge(const histogram_t *const histogram,
+                             const size_t index);
+
+/**
+ * @brief Find the slot of a sample in a histogram's given edges.
+ *
+ * @param histogram A read-only pointer to a histogram with edges.
+ * @param value The sample.
+ *
+ * @return The number of edges at or below the sample: 0 below the bins, 1 +
+ *         the bin, or bins + 1 above them.
+ */
+static size_t histogram_edge_slot(const histogram_t *const histogram,
+                                  const double value);
+
+#if defined(HOST_SSE2)
+/**
+ * @brief Find the slots of two samples in a histogram's equal-width bins.
+ *
+ * The same arithmetic as the scalar path, so both give the same slots.
+ *
+ * @param histogram A read-only pointer to a histogram without edges.
+ * @param values Two samples.
+ *
+ * @return The two slots, in the low two 32-bit lanes.
+ */
+static __m128i histogram_slots_sse2(const histogram_t *const histogram,
+                                    const __m128d values);
+#endif
+
+/*******************************************************************************
+ Function Definitions
+*******************************************************************************/
+#define STATS_SUFFIX
+#define STATS_T unsigned char
+#define STATS_ACC_T uint64_t
+#define STATS_FMT "d"
+#define STATS_KIND STATS_KIND_BYTE
+#define STATS_KEY_T uint8_t
+#include "stats_template.inc"
+
+#define STATS_SUFFIX _u16
+#define STATS_T uint16_t
+#define STATS_ACC_T uint64_t
+#define STATS_FMT PRIu16
+#define STATS_KIND STATS_KIND_UNSIGNED
+#define STATS_KEY_T uint16_t
+#include "stats_template.inc"
+
+#define STATS_SUFFIX _s16
+#define STATS_T int16_t
+#define STATS_ACC_T int64_t
+#define STATS_FMT PRId16
+#define STATS_KIND STATS_KIND_SIGNED
+#define STATS_KEY_T uint16_t
+#include "stats_template.inc"
+
+#define STATS_SUFFIX _u32
+#define STATS_T uint32_t
+#define STATS_ACC_T uint64_t
+#define STATS_FMT PRIu32
+#define STATS_KIND STATS_KIND_UNSIGNED
+#define STATS_KEY_T uint32_t
+#include "stats_template.inc"
+
+#define STATS_SUFFIX _s32
+#define STATS_T int32_t
+#define STATS_ACC_T int64_t
+#define STATS_FMT PRId32
+#define STATS_KIND STATS_KIND_SIGNED
+#define STATS_KEY_T uint32_t
+#include "stats_template.inc"
+
+#define STATS_SUFFIX _f32
+#define STATS_T float
+#define STATS_ACC_T double
+#define STATS_FMT "g"
+#define STATS_KIND STATS_KIND_FLOAT
+#define STATS_KEY_T uint32_t
+#include "stats_template.inc"
+
 // -----------------------------------------------------------------------------
-unsigned char find_median(const unsigned char *const arr,
-                          const unsigned int len) {
-  unsigned char median;
-  // Is odd?
+void find_statistics(const unsigned char *const arr, const size_t len,
+                     unsigned char *const median, unsigned char *const mean,
+                     unsigned char *const max, unsigned char *const min) {
+  partial_stats_t total;
+  accumulate(arr, len, &total);
+
+  const size_t *const histogram = total.histogram;
   if (len % 2 != 0) {
-    const unsigned int middle = len / 2;
-    median = arr[middle];
+    *median = histogram_value_at(histogram, len / 2);
   } else {
-    // Is even.
-    const unsigned int top_half_low = len / 2;
-    const unsigned int bottom_half_high = top_half_low - 1;
-    // No rounding needed because of floating point truncation.
-    median = (arr[bottom_half_high] + arr[top_half_low]) / 2;
+    const size_t top_half_low = len / 2;
+    const size_t bottom_half_high = top_half_low - 1;
+    *median = (histogram_value_at(histogram, bottom_half_high) +
+               histogram_value_at(histogram, top_half_low)) /
+              2;
   }
+  *mean = (unsigned char)(total.sum / len);
+  *max = histogram_value_at(histogram, 0);
+  *min = histogram_value_at(histogram, len - 1);
+}
 
-  return median;
+// -----------------------------------------------------------------------------
+void find_statistics_batch(const unsigned char *const samples, const size_t len,
+                           const size_t count, unsigned char *const median,
+                           unsigned char *const mean, unsigned char *const max,
+                           unsigned char *const min) {
+  size_t first = 0;
+#if defined(HOST_SSE2)
+  if (len <= SORT_NETWORK_MAX_LEN) {
+    for (; first + BATCH_LANES <= count; first += BATCH_LANES)
+      batch_statistics_sse2(samples + first, len, count, median + first,
+                            mean + first, max + first, min + first);
+  }
+#endif
+  for (; first < count; first++)
+    batch_statistics_one(samples + first, len, count, median + first,
+                         mean + first, max + first, min + first);
+}
+
+// -----------------------------------------------------------------------------
+void set_thread_count(const unsigned int count) {
+  thread_count = count > MAX_THREADS ? MAX_THREADS : count;
+#if defined(HOST)
+  if (thread_count == 0) {
+    const long online = sysconf(_SC_NPROCESSORS_ONLN);
+    thread_count = online < 1             ? 1
+                   : online > MAX_THREADS ? MAX_THREADS
+                                          : (unsigned int)online;
+  }
+#else
+  thread_count = 1;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+unsigned int get_thread_count(void) {
+  if (thread_count == 0)
+    set_thread_count(0);
+  return thread_count;
+}
+
+// -----------------------------------------------------------------------------
+uint32_t find_variance_s16(const int16_t *const arr, const size_t len) {
+  int64_t sum;
+  uint64_t sum_squares;
+  sum_squares_s16(arr, len, &sum, &sum_squares);
+
+  uint64_t r;
+  uint64_t spread = spread_from_sums(
+      sum < 0 ? -(uint64_t)sum : (uint64_t)sum, sum_squares, len, &r);
+  // Round the subtracted r^2 / len up so the variance rounds down.
+  spread -= r * r / len + (r * r % len != 0);
+  return (uint32_t)(spread / len);
 }
 
 // -----------------------------------------------------------------------------
-unsigned char find_mean(const unsigned char *const arr,
-                        const unsigned int len) {
-  int sum = 0;
-  for (int i = 0; i < len; i++)
-    sum += arr[i];
-  int mean = sum / len;
-  return (unsigned char)mean;
+uint16_t find_stddev_s16(const int16_t *const arr, const size_t len) {
+  return (uint16_t)integer_sqrt(find_variance_s16(arr, len));
 }
 
 // -----------------------------------------------------------------------------
-unsigned char find_maximum(const unsigned char *const arr,
-                           const unsigned int len) {
-  return arr[0];
+uint32_t integer_sqrt(const uint64_t value) {
+  uint64_t remainder = value;
+  uint64_t root = 0;
+  uint64_t bit = (uint64_t)1 << 62;
+  while (bit != 0) {
+    if (remainder >= root + bit) {
+      remainder -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (uint32_t)root;
+}
+
+// -----------------------------------------------------------------------------
+void covariance_init_s16(covariance_s16_t *const covariance) {
+  covariance->count = 0;
+  covariance->sum_x = 0;
+  covariance->sum_y = 0;
+  covariance->sum_xx = 0;
+  covariance->sum_yy = 0;
+  covariance->sum_xy = 0;
+}
+
+// -----------------------------------------------------------------------------
+void covariance_update_s16(covariance_s16_t *const covariance,
+                           const int16_t *const x, const int16_t *const y,
+                           const size_t len) {
+  size_t i = 0;
+#if defined(HOST_SSE2)
+  i = covariance_s16_sse2(covariance, x, y, len);
+#elif defined(MSP432)
+  /*
+   * As in sum_squares_s16: SMLAD sums two samples into a 32-bit block sum,
+   * and SMLALD adds two products straight into 64 bits.
+   */
+  const uint32_t ones = 0x00010001u;
+  uint64_t sum_xx = covariance->sum_xx;
+  uint64_t sum_yy = covariance->sum_yy;
+  uint64_t sum_xy = (uint64_t)covariance->sum_xy;
+  while (len - i >= 2) {
+    const size_t pairs =
+        (len - i) / 2 < (1u << 15) ? (len - i) / 2 : (1u << 15);
+    uint32_t block_x = 0;
+    uint32_t block_y = 0;
+    for (size_t p = 0; p < pairs; p++, i += 2) {
+      uint32_t both_x;
+      uint32_t both_y;
+      memcpy(&both_x, x + i, sizeof both_x);
+      memcpy(&both_y, y + i, sizeof both_y);
+      block_x = __SMLAD(both_x, ones, block_x);
+      block_y = __SMLAD(both_y, ones, block_y);
+      sum_xx = __SMLALD(both_x, both_x, sum_xx);
+      sum_yy = __SMLALD(both_y, both_y, sum_yy);
+      sum_xy = __SMLALD(both_x, both_y, sum_xy);
+    }
+    covariance->sum_x += (int32_t)block_x;
+    covariance->sum_y += (int32_t)block_y;
+  }
+  covariance->sum_xx = sum_xx;
+  covariance->sum_yy = sum_yy;
+  covariance->sum_xy = (int64_t)sum_xy;
+#endif
+  for (; i < len; i++) {
+    const int32_t a = x[i];
+    const int32_t b = y[i];
+    covariance->sum_x += a;
+    covariance->sum_y += b;
+    covariance->sum_xx += (uint64_t)(a * a);
+    covariance->sum_yy += (uint64_t)(b * b);
+    covariance->sum_xy += a * b;
+  }
+  covariance->count += len;
 }
 
 // -----------------------------------------------------------------------------
-unsigned char find_minimum(const unsigned char *const arr,
-                           const unsigned int len) {
-  return arr[len - 1];
+void covariance_merge_s16(covariance_s16_t *const dst,
+                          const covariance_s16_t *const src) {
+  dst->count += src->count;
+  dst->sum_x += src->sum_x;
+  dst->sum_y += src->sum_y;
+  dst->sum_xx += src->sum_xx;
+  dst->sum_yy += src->sum_yy;
+  dst->sum_xy += src->sum_xy;
 }
 
 // -----------------------------------------------------------------------------
-void print_statistics(const unsigned char median, const unsigned char mean,
-                      const unsigned char max, const unsigned char min) {
-  PRINTF("\nStatistics\n");
+double find_covariance_s16(const covariance_s16_t *const covariance) {
+  return covariance_from_sums(covariance->sum_x, covariance->sum_y,
+                              covariance->sum_xy, covariance->count);
+}
+
+// -----------------------------------------------------------------------------
+double find_correlation_s16(const covariance_s16_t *const covariance) {
+  const int64_t sum_x = covariance->sum_x;
+  const int64_t sum_y = covariance->sum_y;
+  const double variance_x =
+      variance_from_sums(sum_x < 0 ? -(uint64_t)sum_x : (uint64_t)sum_x,
+                         covariance->sum_xx, covariance->count);
+  const double variance_y =
+      variance_from_sums(sum_y < 0 ? -(uint64_t)sum_y : (uint64_t)sum_y,
+                         covariance->sum_yy, covariance->count);
+  if (variance_x <= 0 || variance_y <= 0)
+    return 0;
+  const double correlation = find_covariance_s16(covariance) /
+                             square_root(variance_x * variance_y);
+  // Rounding can carry a perfect correlation just past 1.
+  if (correlation > 1)
+    return 1;
+  return correlation < -1 ? -1 : correlation;
+}
+
+// -----------------------------------------------------------------------------
+void find_regression_s16(const covariance_s16_t *const covariance,
+                         double *const slope, double *const intercept) {
+  const int64_t sum_x = covariance->sum_x;
+  const double count = (double)covariance->count;
+  const double variance_x =
+      variance_from_sums(sum_x < 0 ? -(uint64_t)sum_x : (uint64_t)sum_x,
+                         covariance->sum_xx, covariance->count);
+  *slope = variance_x > 0 ? find_covariance_s16(covariance) / variance_x : 0;
+  *intercept = (double)covariance->sum_y / count -
+               *slope * ((double)sum_x / count);
+}
+
+// -----------------------------------------------------------------------------
+void print_covariance_s16(const covariance_s16_t *const covariance) {
+  double slope;
+  double intercept;
+  find_regression_s16(covariance, &slope, &intercept);
+  PRINTF("\nPaired Statistics\n");
+  PRINTF("%s%10s\n", "What", "Value");
+  PRINTF("%-8s = %" PRIu64 "\n", "Count", covariance->count);
+  PRINTF("%-8s = %g\n", "Covar", find_covariance_s16(covariance));
+  PRINTF("%-8s = %g\n", "Correl", find_correlation_s16(covariance));
+  PRINTF("%-8s = %g\n", "Slope", slope);
+  PRINTF("%-8s = %g\n", "Offset", intercept);
+}
+
+// -----------------------------------------------------------------------------
+void quantile_sketch_init(quantile_sketch_t *const sketch) {
+  sketch->levels = 1;
+  sketch->level_start[0] = QUANTILE_SKETCH_CAPACITY;
+  sketch->level_start[1] = QUANTILE_SKETCH_CAPACITY;
+  sketch->random = 0x9E3779B9u;
+  sketch->count = 0;
+  sketch->min = 0;
+  sketch->max = 0;
+}
+
+// -----------------------------------------------------------------------------
+void quantile_sketch_update(quantile_sketch_t *const sketch,
+                            const float value) {
+  if (sketch->count == 0 || value < sketch->min)
+    sketch->min = value;
+  if (sketch->count == 0 || value > sketch->max)
+    sketch->max = value;
+  sketch->count++;
+  quantile_sketch_insert(sketch, 0, &value, 1);
+}
+
+// -----------------------------------------------------------------------------
+void quantile_sketch_merge(quantile_sketch_t *const dst,
+                           const quantile_sketch_t *const src) {
+  if (src->count == 0)
+    return;
+  if (dst->count == 0 || src->min < dst->min)
+    dst->min = src->min;
+  if (dst->count == 0 || src->max > dst->max)
+    dst->max = src->max;
+  dst->count += src->count;
+  for (unsigned int level = 0; level < src->levels; level++) {
+    const unsigned int start = src->level_start[level];
+    quantile_sketch_insert(dst, level, src->items + start,
+                           src->level_start[level + 1] - start);
+  }
+}
+
+// -----------------------------------------------------------------------------
+float quantile_sketch_query(quantile_sketch_t *const sketch,
+                            const float quantile) {
+  if (quantile <= 0)
+    return sketch->min;
+  if (quantile >= 1)
+    return sketch->max;
+
+  uint64_t total = 0;
+  unsigned int next[QUANTILE_SKETCH_MAX_LEVELS];
+  for (unsigned int level = 0; level < sketch->levels; level++) {
+    const unsigned int start = sketch->level_start[level];
+    const unsigned int len = sketch->level_start[level + 1] - start;
+    quantile_sketch_sort(sketch->items + start, len);
+    total += (uint64_t)len << level;
+    next[level] = start;
+  }
+
+  // Walk all levels from the largest sample down, as in a k-way merge.
+  const uint64_t above = (uint64_t)((1.0 - quantile) * (double)total);
+  uint64_t seen = 0;
+  float value = sketch->min;
+  for (;;) {
+    int best = -1;
+    for (unsigned int level = 0; level < sketch->levels; level++) {
+      if (next[level] < sketch->level_start[level + 1] &&
+          (best < 0 || sketch->items[next[level]] > sketch->items[next[best]]))
+        best = level;
+    }
+    if (best < 0)
+      break;
+    value = sketch->items[next[best]++];
+    seen += (uint64_t)1 << best;
+    if (seen > above)
+      break;
+  }
+  return value;
+}
+
+// -----------------------------------------------------------------------------
+void print_quantiles(quantile_sketch_t *const sketch) {
+  PRINTF("\nQuantiles\n");
   PRINTF("%s%10s\n", "What", "Value");
-  PRINTF("%-8s = %i\n", "Median", median);
-  PRINTF("%-8s = %i\n", "Mean", mean);
-  PRINTF("%-8s = %i\n", "Max", max);
-  PRINTF("%-8s = %i\n", "Min", min);
+  PRINTF("%-8s = %g\n", "p50", quantile_sketch_query(sketch, 0.5f));
+  PRINTF("%-8s = %g\n", "p90", quantile_sketch_query(sketch, 0.9f));
+  PRINTF("%-8s = %g\n", "p99", quantile_sketch_query(sketch, 0.99f));
+  PRINTF("%-8s = %g\n", "p999", quantile_sketch_query(sketch, 0.999f));
+}
+
+// -----------------------------------------------------------------------------
+void group_init(group_table_t *const table) {
+  memset(table, 0, sizeof(*table));
+}
+
+// -----------------------------------------------------------------------------
+void group_update(group_table_t *const table,
+                  const keyed_sample_t *const samples, const size_t len) {
+  group_part_t part = {table, samples, len};
+#if defined(HOST)
+  const size_t threads = get_thread_count();
+  if (len < PARALLEL_MIN_LEN || threads < 2) {
+    group_update_partial(&part);
+    return;
+  }
+
+  // Thread 0 works on the caller's table; the others each get their own.
+  const size_t words =
+      (sizeof(group_table_t) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+  group_table_t *const tables =
+      (group_table_t *)reserve_words((threads - 1) * words);
+  if (tables == NULL) {
+    group_update_partial(&part);
+    return;
+  }
+
+  group_part_t parts[MAX_THREADS];
+  const size_t slice = len / threads;
+  for (size_t t = 0; t < threads; t++) {
+    parts[t].table = t == 0 ? table : &tables[t - 1];
+    parts[t].samples = samples + t * slice;
+    parts[t].len = t == threads - 1 ? len - t * slice : slice;
+    if (t > 0)
+      group_init(parts[t].table);
+  }
+  run_parallel(group_update_partial, parts, sizeof(parts[0]), threads);
+
+  for (size_t t = 1; t < threads; t++)
+    group_merge(table, &tables[t - 1]);
+  free_words((const uint32_t *)tables);
+#else
+  group_update_partial(&part);
+#endif
+}
+
+// -----------------------------------------------------------------------------
+void group_merge(group_table_t *const dst, const group_table_t *const src) {
+  for (size_t i = 0; i < GROUP_DENSE_KEYS; i++)
+    if (src->dense[i].count != 0)
+      group_fold(dst, &src->dense[i]);
+  for (size_t i = 0; i < GROUP_HASH_SLOTS; i++)
+    if (src->slots[i].count != 0)
+      group_fold(dst, &src->slots[i]);
+  dst->dropped += src->dropped;
+}
+
+// -----------------------------------------------------------------------------
+const group_stats_t *group_find(const group_table_t *const table,
+                                const uint32_t key) {
+  // group_entry only claims a slot when the caller writes to it.
+  const group_stats_t *const entry = group_entry((group_table_t *)table, key);
+  return entry != NULL && entry->count != 0 ? entry : NULL;
+}
+
+// -----------------------------------------------------------------------------
+int32_t group_mean(const group_stats_t *const stats) {
+  return (int32_t)(stats->sum / (int64_t)stats->count);
+}
+
+// -----------------------------------------------------------------------------
+void print_groups(const group_table_t *const table) {
+  PRINTF("\nGroups\n");
+  PRINTF("%10s%12s%12s%12s%12s\n", "Key", "Count", "Mean", "Max", "Min");
+  for (size_t i = 0; i < GROUP_DENSE_KEYS + GROUP_HASH_SLOTS; i++) {
+    const group_stats_t *const stats =
+        i < GROUP_DENSE_KEYS ? &table->dense[i]
+                             : &table->slots[i - GROUP_DENSE_KEYS];
+    if (stats->count != 0)
+      PRINTF("%10" PRIu32 "%12" PRIu64 "%12" PRId32 "%12" PRId32 "%12" PRId32
+             "\n",
+             stats->key, stats->count, group_mean(stats), stats->maximum,
+             stats->minimum);
+  }
+  if (table->dropped != 0)
+    PRINTF("%-8s = %" PRIu64 "\n", "Dropped", table->dropped);
+}
+
+// -----------------------------------------------------------------------------
+void histogram_init_uniform(histogram_t *const histogram, size_t *const counts,
+                            const size_t bins, const double low,
+                            const double high) {
+  histogram_init_edges(histogram, counts, bins, NULL);
+  histogram->low = low;
+  histogram->scale = (double)bins / (high - low);
+}
+
+// -----------------------------------------------------------------------------
+void histogram_init_edges(histogram_t *const histogram, size_t *const counts,
+                          const size_t bins, const double *const edges) {
+  for (size_t i = 0; i < bins; i++)
+    counts[i] = 0;
+  histogram->counts = counts;
+  histogram->edges = edges;
+  histogram->low = edges ? edges[0] : 0;
+  histogram->scale = 0;
+  histogram->bins = bins;
+  histogram->below = 0;
+  histogram->above = 0;
+}
+
+// -----------------------------------------------------------------------------
+void histogram_merge(histogram_t *const dst, const histogram_t *const src) {
+  for (size_t i = 0; i < dst->bins; i++)
+    dst->counts[i] += src->counts[i];
+  dst->below += src->below;
+  dst->above += src->above;
+}
+
+// -----------------------------------------------------------------------------
+void print_histogram(const histogram_t *const histogram) {
+  size_t largest = 1;
+  for (size_t i = 0; i < histogram->bins; i++)
+    if (histogram->counts[i] > largest)
+      largest = histogram->counts[i];
+
+  const double lowest = histogram_edge(histogram, 0);
+  const double highest = histogram_edge(histogram, histogram->bins);
+  PRINTF("\nHistogram\n");
+  PRINTF("%12s %12s %12s\n", "From", "To", "Count");
+  if (histogram->below)
+    PRINTF("%12s %12g %12zu\n", "-", lowest, histogram->below);
+  size_t empty = 0;
+  for (size_t i = 0; i < histogram->bins; i++) {
+    const size_t count = histogram->counts[i];
+    if (count == 0) {
+      empty++;
+      continue;
+    }
+    if (empty)
+      PRINTF("%12s %zu empty\n", "...", empty);
+    empty = 0;
+    const double from = histogram_edge(histogram, i);
+    const double to = histogram_edge(histogram, i + 1);
+    PRINTF("%12g %12g %12zu ", from, to, count);
+    // PRINTF expands to nothing on the MSP432.
+    (void)from;
+    (void)to;
+    const size_t bar = (count * HISTOGRAM_BAR_WIDTH + largest - 1) / largest;
+    for (size_t c = 0; c < bar; c++)
+      PRINTF("#");
+    PRINTF("\n");
+  }
+  if (empty)
+    PRINTF("%12s %zu empty\n", "...", empty);
+  if (histogram->above)
+    PRINTF("%12g %12s %12zu\n", highest, "-", histogram->above);
+  (void)lowest;
+  (void)highest;
+}
+
+// -----------------------------------------------------------------------------
+static void sum_squares_s16(const int16_t *const arr, const size_t len,
+                            int64_t *const sum, uint64_t *const sum_squares) {
+  int64_t total = 0;
+  uint64_t squares = 0;
+  size_t i = 0;
+#if defined(MSP432)
+  /*
+   * Each SMLAD adds two samples into a 32-bit sum, which is safe for 2^15
+   * pairs before it has to be moved into the 64-bit one; SMLALD adds the
+   * squares of both straight into 64 bits.
+   */
+  const uint32_t ones = 0x00010001u;
+  while (len - i >= 2) {
+    const size_t pairs =
+        (len - i) / 2 < (1u << 15) ? (len - i) / 2 : (1u << 15);
+    uint32_t block = 0;
+    for (size_t p = 0; p < pairs; p++, i += 2) {
+      uint32_t both;
+      memcpy(&both, arr + i, sizeof both);
+      block = __SMLAD(both, ones, block);
+      squares = __SMLALD(both, both, squares);
+    }
+    total += (int32_t)block;
+  }
+#endif
+  for (; i < len; i++) {
+    total += arr[i];
+    squares += (uint64_t)((int32_t)arr[i] * arr[i]);
+  }
+  *sum = total;
+  *sum_squares = squares;
+}
+
+// -----------------------------------------------------------------------------
+static uint64_t sum_bytes(const unsigned char *const arr, const size_t len) {
+  uint64_t total = 0;
+  size_t i = 0;
+#if defined(HOST_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  __m128i sums = _mm_setzero_si128();
+  for (; len - i >= 16; i += 16) {
+    const __m128i bytes = _mm_loadu_si128((const __m128i *)(arr + i));
+    sums = _mm_add_epi64(sums, _mm_sad_epu8(bytes, zero));
+  }
+  uint64_t lanes[2];
+  _mm_storeu_si128((__m128i *)lanes, sums);
+  total = lanes[0] + lanes[1];
+#elif defined(MSP432)
+  // A word adds at most 4 * 255, so 2^22 words fit the 32-bit sum.
+  while (len - i >= 4) {
+    const size_t words = (len - i) / 4 < ((size_t)1 << 22)
+                             ? (len - i) / 4
+                             : ((size_t)1 << 22);
+    uint32_t block = 0;
+    for (size_t w = 0; w < words; w++, i += 4) {
+      uint32_t four;
+      memcpy(&four, arr + i, sizeof four);
+      block = __USADA8(four, 0, block);
+    }
+    total += block;
+  }
+#endif
+  while (i < len) {
+    const size_t end = len - i > SUM_BLOCK_8 ? i + SUM_BLOCK_8 : len;
+    uint16_t block = 0;
+    for (; i < end; i++)
+      block += arr[i];
+    total += block;
+  }
+  return total;
+}
+
+// -----------------------------------------------------------------------------
+static unsigned int quantile_sketch_level_capacity(
+    const quantile_sketch_t *const sketch, const unsigned int level) {
+  unsigned int capacity = QUANTILE_SKETCH_K;
+  for (unsigned int depth = sketch->levels - 1 - level;
+       depth > 0 && capacity > QUANTILE_SKETCH_MIN_LEVEL; depth--)
+    capacity = capacity * 2 / 3;
+  return capacity < QUANTILE_SKETCH_MIN_LEVEL ? QUANTILE_SKETCH_MIN_LEVEL
+                                              : capacity;
+}
+
+// -----------------------------------------------------------------------------
+static void quantile_sketch_compress(quantile_sketch_t *const sketch) {
+  uint16_t *const level_start = sketch->level_start;
+  unsigned int level = 0;
+  while (level + 1 < sketch->levels &&
+         level_start[level + 1] - level_start[level] <
+             quantile_sketch_level_capacity(sketch, level))
+    level++;
+  if (level + 1 == sketch->levels &&
+      sketch->levels < QUANTILE_SKETCH_MAX_LEVELS) {
+    // Promote into a new, empty top level.
+    level_start[sketch->levels + 1] = QUANTILE_SKETCH_CAPACITY;
+    sketch->levels++;
+  }
+  /*
+   * Past QUANTILE_SKETCH_MAX_LEVELS the top level compacts into itself; the
+   * quantiles stay usable but lose weight at the top of the ranks.
+   */
+  const unsigned int above = level + 1 < sketch->levels ? level + 1 : level;
+
+  const unsigned int start = level_start[level];
+  const unsigned int end = level_start[level + 1];
+  quantile_sketch_sort(sketch->items + start, end - start);
+  // An odd sample out stays behind at the front of the level.
+  const unsigned int odd = (end - start) % 2;
+  const unsigned int pairs = (end - start) / 2;
+  // xorshift32 picks whether the first or second of each pair survives.
+  sketch->random ^= sketch->random << 13;
+  sketch->random ^= sketch->random >> 17;
+  sketch->random ^= sketch->random << 5;
+  const unsigned int offset = sketch->random & 1;
+  // Survivors move to the end of the level, which then joins the one above.
+  for (unsigned int i = pairs; i > 0; i--) {
+    sketch->items[start + odd + pairs + i - 1] =
+        sketch->items[start + odd + 2 * (i - 1) + offset];
+  }
+  if (above != level)
+    level_start[above] = start + odd + pairs;
+  else
+    level_start[level + 1] = start + odd + 2 * pairs;
+
+  // Close the gap left by the discarded half.
+  const unsigned int keep = start + odd - level_start[0];
+  for (unsigned int i = keep; i > 0; i--)
+    sketch->items[level_start[0] + pairs + i - 1] =
+        sketch->items[level_start[0] + i - 1];
+  for (unsigned int l = 0; l <= level; l++)
+    level_start[l] += pairs;
+}
+
+// -----------------------------------------------------------------------------
+static void quantile_sketch_insert(quantile_sketch_t *const sketch,
+                                   const unsigned int level,
+                                   const float *const values,
+                                   const unsigned int count) {
+  unsigned int to = level;
+  while (to >= sketch->levels && sketch->levels < QUANTILE_SKETCH_MAX_LEVELS) {
+    sketch->level_start[sketch->levels + 1] = QUANTILE_SKETCH_CAPACITY;
+    sketch->levels++;
+  }
+  if (to >= sketch->levels)
+    to = sketch->levels - 1;
+  for (unsigned int done = 0; done < count;) {
+    if (sketch->level_start[0] == 0)
+      quantile_sketch_compress(sketch);
+    const unsigned int room = sketch->level_start[0];
+    const unsigned int block = count - done < room ? count - done : room;
+    // Shift the levels below this one down to open a block at its front.
+    const unsigned int first = sketch->level_start[0];
+    const unsigned int last = sketch->level_start[to];
+    memmove(sketch->items + first - block, sketch->items + first,
+            (last - first) * sizeof(float));
+    for (unsigned int l = 0; l <= to; l++)
+      sketch->level_start[l] -= block;
+    memcpy(sketch->items + sketch->level_start[to], values + done,
+           block * sizeof(float));
+    done += block;
+  }
+}
+
+// -----------------------------------------------------------------------------
+static void quantile_sketch_sort(float *const items, const unsigned int len) {
+  if (len <= SORT_NETWORK_MAX_LEN)
+    sort_network_f32(items, len);
+  else
+    heap_select_f32(items, len, items, len, 1);
+}
+
+#if defined(HOST_SSE2)
+// -----------------------------------------------------------------------------
+static void sort_network_sse2(unsigned char *const arr, const size_t len) {
+  enum { STRIDE = SORT_NETWORK_MAX_LEN + 2 * SORT_NETWORK_MARGIN };
+  unsigned char buffers[2][STRIDE] __attribute__((aligned(16))) = {{0}};
+  unsigned char *from = buffers[0] + SORT_NETWORK_MARGIN;
+  unsigned char *to = buffers[1] + SORT_NETWORK_MARGIN;
+  my_memcopy(arr, from, len);
+
+  const __m128i lane = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12,
+                                     13, 14, 15);
+  // Same schedule as the scalar sort_network; see Knuth's Algorithm 5.2.2M.
+  size_t top = 1;
+  while (top < len)
+    top <<= 1;
+  top >>= 1;
+  for (size_t p = top; p > 0; p >>= 1) {
+    size_t q = top;
+    size_t r = 0;
+    size_t d = p;
+    for (;;) {
+      const __m128i bit = _mm_set1_epi8((char)p);
+      const __m128i want = _mm_set1_epi8((char)r);
+      const __m128i upper_limit = _mm_set1_epi8((char)(len - d));
+      const __m128i lower_first = _mm_set1_epi8((char)(d - 1));
+      const __m128i lower_limit = _mm_set1_epi8((char)len);
+      for (size_t i = 0; i < len; i += 16) {
+        const __m128i index = _mm_add_epi8(lane, _mm_set1_epi8((char)i));
+        const __m128i shifted = _mm_sub_epi8(index, _mm_set1_epi8((char)d));
+        // Upper end: (index & p) == r and index + d < len.
+        const __m128i is_upper = _mm_and_si128(
+            _mm_cmpeq_epi8(_mm_and_si128(index, bit), want),
+            _mm_cmplt_epi8(index, upper_limit));
+        // Lower end: index >= d, ((index - d) & p) == r and index < len.
+        const __m128i is_lower = _mm_and_si128(
+            _mm_and_si128(_mm_cmpgt_epi8(index, lower_first),
+                          _mm_cmplt_epi8(index, lower_limit)),
+            _mm_cmpeq_epi8(_mm_and_si128(shifted, bit), want));
+        const __m128i here = _mm_loadu_si128((const __m128i *)(from + i));
+        const __m128i above = _mm_loadu_si128((const __m128i *)(from + i + d));
+        const __m128i below = _mm_loadu_si128((const __m128i *)(from + i - d));
+        const __m128i larger = _mm_max_epu8(here, above);
+        const __m128i smaller = _mm_min_epu8(here, below);
+        __m128i result = _mm_or_si128(_mm_and_si128(is_upper, larger),
+                                      _mm_andnot_si128(is_upper, here));
+        result = _mm_or_si128(_mm_and_si128(is_lower, smaller),
+                              _mm_andnot_si128(is_lower, result));
+        _mm_storeu_si128((__m128i *)(to + i), result);
+      }
+      unsigned char *const tmp = from;
+      from = to;
+      to = tmp;
+      if (q == p)
+        break;
+      d = q - p;
+      q >>= 1;
+      r = p;
+    }
+  }
+  my_memcopy(from, arr, len);
+}
+
+// -----------------------------------------------------------------------------
+static void sort_network_sse2_16(void *const arr, const size_t len,
+                                 const uint16_t flip) {
+  int16_t keys[SORT_NETWORK_MAX_LEN];
+  my_memcopy((const uint8_t *)arr, (uint8_t *)keys, len * sizeof(int16_t));
+  for (size_t i = 0; i < len; i++)
+    keys[i] = (int16_t)(keys[i] ^ flip);
+
+  const __m128i lane = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+  // Same schedule as the scalar sort_network; see Knuth's Algorithm 5.2.2M.
+  size_t top = 1;
+  while (top < len)
+    top <<= 1;
+  top >>= 1;
+  for (size_t p = top; p > 0; p >>= 1) {
+    size_t q = top;
+    size_t r = 0;
+    size_t d = p;
+    for (;;) {
+      size_t i = 0;
+      if (d >= 8) {
+        const __m128i bit = _mm_set1_epi16((short)p);
+        const __m128i want = _mm_set1_epi16((short)r);
+        for (; i + d + 8 <= len; i += 8) {
+          const __m128i index = _mm_add_epi16(lane, _mm_set1_epi16((short)i));
+          const __m128i is_lower =
+              _mm_cmpeq_epi16(_mm_and_si128(index, bit), want);
+          const __m128i a = _mm_loadu_si128((const __m128i *)(keys + i));
+          const __m128i b = _mm_loadu_si128((const __m128i *)(keys + i + d));
+          _mm_storeu_si128(
+              (__m128i *)(keys + i),
+              _mm_or_si128(_mm_and_si128(is_lower, _mm_max_epi16(a, b)),
+                           _mm_andnot_si128(is_lower, a)));
+          _mm_storeu_si128(
+              (__m128i *)(keys + i + d),
+              _mm_or_si128(_mm_and_si128(is_lower, _mm_min_epi16(a, b)),
+                           _mm_andnot_si128(is_lower, b)));
+        }
+      }
+      for (; i + d < len; i++) {
+        if ((i & p) == r && keys[i] < keys[i + d]) {
+          const int16_t a = keys[i];
+          keys[i] = keys[i + d];
+          keys[i + d] = a;
+        }
+      }
+      if (q == p)
+        break;
+      d = q - p;
+      q >>= 1;
+      r = p;
+    }
+  }
+  for (size_t i = 0; i < len; i++)
+    keys[i] = (int16_t)(keys[i] ^ flip);
+  my_memcopy((const uint8_t *)keys, (uint8_t *)arr, len * sizeof(int16_t));
 }
 
 // -----------------------------------------------------------------------------
-void print_array(const unsigned char *const arr, const unsigned int len) {
-#if defined(VERBOSE)
-  PRINTF("[ ");
-  for (int i = 0; i < len; i++) {
-    PRINTF("%d", arr[i]);
-    if (i < len - 1) {
-      PRINTF(", ");
+static void sort_network_sse2_32(void *const arr, const size_t len,
+                                 const uint32_t flip, const int floats) {
+  uint32_t keys[SORT_NETWORK_MAX_LEN];
+  my_memcopy((const uint8_t *)arr, (uint8_t *)keys, len * sizeof(uint32_t));
+  // Flipping all but the sign bit of a negative float undoes itself.
+  for (size_t i = 0; i < len; i++)
+    keys[i] ^= floats ? (0u - (keys[i] >> 31)) >> 1 : flip;
+
+  const __m128i lane = _mm_setr_epi32(0, 1, 2, 3);
+  // Same schedule as the scalar sort_network; see Knuth's Algorithm 5.2.2M.
+  size_t top = 1;
+  while (top < len)
+    top <<= 1;
+  top >>= 1;
+  for (size_t p = top; p > 0; p >>= 1) {
+    size_t q = top;
+    size_t r = 0;
+    size_t d = p;
+    for (;;) {
+      size_t i = 0;
+      if (d >= 4) {
+        const __m128i bit = _mm_set1_epi32((int)p);
+        const __m128i want = _mm_set1_epi32((int)r);
+        for (; i + d + 4 <= len; i += 4) {
+          const __m128i index = _mm_add_epi32(lane, _mm_set1_epi32((int)i));
+          const __m128i a = _mm_loadu_si128((const __m128i *)(keys + i));
+          const __m128i b = _mm_loadu_si128((const __m128i *)(keys + i + d));
+          // Swap the pairs of the step that are out of order.
+          const __m128i swap =
+              _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(index, bit), want),
+                            _mm_cmpgt_epi32(b, a));
+          const __m128i change = _mm_and_si128(swap, _mm_xor_si128(a, b));
+          _mm_storeu_si128((__m128i *)(keys + i), _mm_xor_si128(a, change));
+          _mm_storeu_si128((__m128i *)(keys + i + d),
+                           _mm_xor_si128(b, change));
+        }
+      }
+      for (; i + d < len; i++) {
+        if ((i & p) == r && (int32_t)keys[i] < (int32_t)keys[i + d]) {
+          const uint32_t a = keys[i];
+          keys[i] = keys[i + d];
+          keys[i + d] = a;
+        }
+      }
+      if (q == p)
+        break;
+      d = q - p;
+      q >>= 1;
+      r = p;
     }
   }
-  PRINTF(" ]\n");
+  for (size_t i = 0; i < len; i++)
+    keys[i] ^= floats ? (0u - (keys[i] >> 31)) >> 1 : flip;
+  my_memcopy((const uint8_t *)keys, (uint8_t *)arr, len * sizeof(uint32_t));
+}
 #endif
+
+// -----------------------------------------------------------------------------
+static uint64_t spread_from_sums(const uint64_t magnitude,
+                                 const uint64_t sum_squares, const size_t len,
+                                 uint64_t *const remainder) {
+  const uint64_t q = magnitude / len;
+  const uint64_t r = magnitude % len;
+  *remainder = r;
+  return sum_squares - q * q * len - 2 * q * r;
+}
+
+// -----------------------------------------------------------------------------
+static double variance_from_sums(const uint64_t magnitude,
+                                 const uint64_t sum_squares, const size_t len) {
+  uint64_t r;
+  const uint64_t whole = spread_from_sums(magnitude, sum_squares, len, &r);
+  return ((double)whole - (double)r * (double)r / len) / len;
+}
+
+// -----------------------------------------------------------------------------
+static double covariance_from_sums(const int64_t sum_x, const int64_t sum_y,
+                                   const int64_t sum_xy, const uint64_t len) {
+  const int64_t n = (int64_t)len;
+  const int64_t q_x = sum_x / n;
+  const int64_t r_x = sum_x % n;
+  const int64_t q_y = sum_y / n;
+  const int64_t r_y = sum_y % n;
+  const int64_t whole = sum_xy - q_x * sum_y - r_x * q_y;
+  return ((double)whole - (double)r_x * (double)r_y / (double)n) / (double)n;
+}
+
+// -----------------------------------------------------------------------------
+static double square_root(const double value) {
+  if (value <= 0)
+    return 0;
+  // From above the root every step is smaller, until rounding stops it.
+  double root = value > 1 ? value : 1;
+  for (;;) {
+    const double next = (root + value / root) / 2;
+    if (next >= root)
+      return root;
+    root = next;
+  }
 }
 
+#if defined(HOST_SSE2)
+// -----------------------------------------------------------------------------
+static size_t describe_16_sse2(const uint16_t *const arr, const size_t len,
+                               const int is_unsigned, uint16_t *const scratch,
+                               int32_t *const minimum, int32_t *const maximum,
+                               int64_t *const sum,
+                               uint64_t *const sum_squares) {
+  const size_t whole = len / 8 * 8;
+  if (whole == 0)
+    return 0;
+  const __m128i offset = _mm_set1_epi16(is_unsigned ? (short)0x8000 : 0);
+  const __m128i ones = _mm_set1_epi16(1);
+  const __m128i zero = _mm_setzero_si128();
+  __m128i low = _mm_set1_epi16(0x7FFF);
+  __m128i high = _mm_set1_epi16((short)0x8000);
+  __m128i squares = _mm_setzero_si128();
+  int64_t total = 0;
+
+  for (size_t start = 0; start < whole;) {
+    // A pair sums to at most 2^16 in magnitude, so 2^15 groups fit 32 bits.
+    const size_t block_end =
+        whole - start > (8u << 15) ? start + (8u << 15) : whole;
+    __m128i pair_sums = _mm_setzero_si128();
+    for (; start < block_end; start += 8) {
+      const __m128i raw = _mm_loadu_si128((const __m128i *)(arr + start));
+      if (scratch)
+        _mm_storeu_si128((__m128i *)(scratch + start), raw);
+      const __m128i value = _mm_xor_si128(raw, offset);
+      low = _mm_min_epi16(low, value);
+      high = _mm_max_epi16(high, value);
+      pair_sums = _mm_add_epi32(pair_sums, _mm_madd_epi16(value, ones));
+      // Two squares of -2^15 make 2^31, which only fits read as unsigned.
+      const __m128i pair_squares = _mm_madd_epi16(value, value);
+      squares = _mm_add_epi64(squares, _mm_unpacklo_epi32(pair_squares, zero));
+      squares = _mm_add_epi64(squares, _mm_unpackhi_epi32(pair_squares, zero));
+    }
+    int32_t lanes[4];
+    _mm_storeu_si128((__m128i *)lanes, pair_sums);
+    total += (int64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  }
+
+  int16_t lows[8];
+  int16_t highs[8];
+  uint64_t square_lanes[2];
+  _mm_storeu_si128((__m128i *)lows, low);
+  _mm_storeu_si128((__m128i *)highs, high);
+  _mm_storeu_si128((__m128i *)square_lanes, squares);
+  int32_t smallest = lows[0];
+  int32_t largest = highs[0];
+  for (size_t lane = 1; lane < 8; lane++) {
+    smallest = lows[lane] < smallest ? lows[lane] : smallest;
+    largest = highs[lane] > largest ? highs[lane] : largest;
+  }
+  uint64_t total_squares = square_lanes[0] + square_lanes[1];
+
+  if (is_unsigned) {
+    // Undo the offset: x = y + 2^15, so x^2 = y^2 + 2^16 * y + 2^30.
+    total_squares += ((uint64_t)total << 16) + ((uint64_t)whole << 30);
+    total += (int64_t)whole << 15;
+    smallest += 1 << 15;
+    largest += 1 << 15;
+  }
+  *minimum = smallest;
+  *maximum = largest;
+  *sum = total;
+  *sum_squares = total_squares;
+  return whole;
+}
+#endif
+
+#if defined(HOST_SSE2)
 // -----------------------------------------------------------------------------
-void sort_array(unsigned char *const arr, const unsigned int len) {
-  if (len > 1)
-    quicksort(arr, 0, len - 1);
+static size_t covariance_s16_sse2(covariance_s16_t *const covariance,
+                                  const int16_t *const x,
+                                  const int16_t *const y, const size_t len) {
+  const size_t whole = len / 8 * 8;
+  const __m128i ones = _mm_set1_epi16(1);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i overflow = _mm_set1_epi32(INT32_MIN);
+  __m128i squares_x = zero;
+  __m128i squares_y = zero;
+  __m128i products = zero;
+  int64_t total_x = 0;
+  int64_t total_y = 0;
+
+  for (size_t start = 0; start < whole;) {
+    // A pair sums to at most 2^16 in magnitude, so 2^15 groups fit 32 bits.
+    const size_t block_end =
+        whole - start > (8u << 15) ? start + (8u << 15) : whole;
+    __m128i pair_sums_x = zero;
+    __m128i pair_sums_y = zero;
+    for (; start < block_end; start += 8) {
+      const __m128i a = _mm_loadu_si128((const __m128i *)(x + start));
+      const __m128i b = _mm_loadu_si128((const __m128i *)(y + start));
+      pair_sums_x = _mm_add_epi32(pair_sums_x, _mm_madd_epi16(a, ones));
+      pair_sums_y = _mm_add_epi32(pair_sums_y, _mm_madd_epi16(b, ones));
+      // Two squares of -2^15 make 2^31, which only fits read as unsigned.
+      const __m128i pair_squares_x = _mm_madd_epi16(a, a);
+      const __m128i pair_squares_y = _mm_madd_epi16(b, b);
+      squares_x =
+          _mm_add_epi64(squares_x, _mm_unpacklo_epi32(pair_squares_x, zero));
+      squares_x =
+          _mm_add_epi64(squares_x, _mm_unpackhi_epi32(pair_squares_x, zero));
+      squares_y =
+          _mm_add_epi64(squares_y, _mm_unpacklo_epi32(pair_squares_y, zero));
+      squares_y =
+          _mm_add_epi64(squares_y, _mm_unpackhi_epi32(pair_squares_y, zero));
+      // Products are signed, and INT32_MIN can only be that same 2^31, so
+      // every lane but that one is sign-extended.
+      const __m128i pair_products = _mm_madd_epi16(a, b);
+      const __m128i sign =
+          _mm_andnot_si128(_mm_cmpeq_epi32(pair_products, overflow),
+                           _mm_srai_epi32(pair_products, 31));
+      products =
+          _mm_add_epi64(products, _mm_unpacklo_epi32(pair_products, sign));
+      products =
+          _mm_add_epi64(products, _mm_unpackhi_epi32(pair_products, sign));
+    }
+    int32_t lanes_x[4];
+    int32_t lanes_y[4];
+    _mm_storeu_si128((__m128i *)lanes_x, pair_sums_x);
+    _mm_storeu_si128((__m128i *)lanes_y, pair_sums_y);
+    total_x += (int64_t)lanes_x[0] + lanes_x[1] + lanes_x[2] + lanes_x[3];
+    total_y += (int64_t)lanes_y[0] + lanes_y[1] + lanes_y[2] + lanes_y[3];
+  }
+
+  uint64_t lanes_xx[2];
+  uint64_t lanes_yy[2];
+  int64_t lanes_xy[2];
+  _mm_storeu_si128((__m128i *)lanes_xx, squares_x);
+  _mm_storeu_si128((__m128i *)lanes_yy, squares_y);
+  _mm_storeu_si128((__m128i *)lanes_xy, products);
+  covariance->sum_x += total_x;
+  covariance->sum_y += total_y;
+  covariance->sum_xx += lanes_xx[0] + lanes_xx[1];
+  covariance->sum_yy += lanes_yy[0] + lanes_yy[1];
+  covariance->sum_xy += lanes_xy[0] + lanes_xy[1];
+  return whole;
 }
+#endif
 
 // -----------------------------------------------------------------------------
-void quicksort(unsigned char *const arr, const int low, const int high) {
-  if (low < high) {
-    const int pivot_index = partition(arr, low, high);
-    quicksort(arr, low, pivot_index - 1);
-    quicksort(arr, pivot_index + 1, high);
+static void batch_statistics_one(const unsigned char *const samples,
+                                 const size_t len, const size_t stride,
+                                 unsigned char *const median,
+                                 unsigned char *const mean,
+                                 unsigned char *const max,
+                                 unsigned char *const min) {
+  if (len <= SORT_NETWORK_MAX_LEN) {
+    unsigned char column[SORT_NETWORK_MAX_LEN];
+    for (size_t i = 0; i < len; i++)
+      column[i] = samples[(size_t)i * stride];
+    sort_network(column, len);
+    *median = find_median(column, len);
+    *mean = find_mean(column, len);
+    *max = find_maximum(column, len);
+    *min = find_minimum(column, len);
+    return;
+  }
+
+  // Too long for a network; a histogram does not need the samples together.
+  size_t histogram[HISTOGRAM_BINS] = {0};
+  uint64_t sum = 0;
+  for (size_t i = 0; i < len; i++) {
+    const unsigned char value = samples[(size_t)i * stride];
+    histogram[value]++;
+    sum += value;
   }
+  if (len % 2 != 0) {
+    *median = histogram_value_at(histogram, len / 2);
+  } else {
+    *median = (histogram_value_at(histogram, len / 2 - 1) +
+               histogram_value_at(histogram, len / 2)) /
+              2;
+  }
+  *mean = (unsigned char)(sum / len);
+  *max = histogram_value_at(histogram, 0);
+  *min = histogram_value_at(histogram, len - 1);
 }
 
+#if defined(HOST_SSE2)
 // -----------------------------------------------------------------------------
-int partition(unsigned char *const arr, const int low, const int high) {
-  const unsigned char pivot = arr[high];
-  int i = low - 1;
+static void batch_statistics_sse2(const unsigned char *const samples,
+                                  const size_t len, const size_t stride,
+                                  unsigned char *const median,
+                                  unsigned char *const mean,
+                                  unsigned char *const max,
+                                  unsigned char *const min) {
+  // Zeroed only so the compiler can see every row read is written first.
+  __m128i rows[SORT_NETWORK_MAX_LEN] = {{0}};
+  __m128i sum_low = _mm_setzero_si128();
+  __m128i sum_high = _mm_setzero_si128();
+  const __m128i zero = _mm_setzero_si128();
+  for (size_t i = 0; i < len; i++) {
+    rows[i] = _mm_loadu_si128((const __m128i *)(samples + (size_t)i * stride));
+    // 64 samples of at most 255 fit a 16-bit lane.
+    sum_low = _mm_add_epi16(sum_low, _mm_unpacklo_epi8(rows[i], zero));
+    sum_high = _mm_add_epi16(sum_high, _mm_unpackhi_epi8(rows[i], zero));
+  }
 
-  for (int j = low; j < high; j++) {
-    if (arr[j] >= pivot) {
-      i++;
-      const unsigned char tmp = arr[i];
-      arr[i] = arr[j];
-      arr[j] = tmp;
+  // sort_network's schedule, with every compare-exchange done on 16 lanes.
+  size_t top = 1;
+  while (top < len)
+    top <<= 1;
+  top >>= 1;
+  for (size_t p = top; p > 0; p >>= 1) {
+    size_t q = top;
+    size_t r = 0;
+    size_t d = p;
+    for (;;) {
+      for (size_t i = 0; i + d < len; i++) {
+        if ((i & p) == r) {
+          const __m128i a = rows[i];
+          const __m128i b = rows[i + d];
+          rows[i] = _mm_max_epu8(a, b);
+          rows[i + d] = _mm_min_epu8(a, b);
+        }
+      }
+      if (q == p)
+        break;
+      d = q - p;
+      q >>= 1;
+      r = p;
     }
   }
-  const unsigned char tmp = arr[i + 1];
-  arr[i + 1] = arr[high];
-  arr[high] = tmp;
 
-  return i + 1;
+  __m128i middle = rows[len / 2];
+  if (len % 2 == 0) {
+    // Truncating average: (a & b) + ((a ^ b) >> 1), per byte.
+    const __m128i a = rows[len / 2 - 1];
+    const __m128i half = _mm_and_si128(
+        _mm_srli_epi16(_mm_xor_si128(a, middle), 1), _mm_set1_epi8(0x7F));
+    middle = _mm_add_epi8(_mm_and_si128(a, middle), half);
+  }
+  _mm_storeu_si128((__m128i *)median, middle);
+  _mm_storeu_si128((__m128i *)max, rows[0]);
+  _mm_storeu_si128((__m128i *)min, rows[len - 1]);
+
+  uint16_t sums[BATCH_LANES];
+  _mm_storeu_si128((__m128i *)sums, sum_low);
+  _mm_storeu_si128((__m128i *)(sums + 8), sum_high);
+  for (size_t lane = 0; lane < BATCH_LANES; lane++)
+    mean[lane] = (unsigned char)(sums[lane] / len);
+}
+#endif
+
+// -----------------------------------------------------------------------------
+static void histogram_tally(histogram_t *const histogram, const size_t slot,
+                            const size_t count) {
+  if (slot == 0)
+    histogram->below += count;
+  else if (slot > histogram->bins)
+    histogram->above += count;
+  else
+    histogram->counts[slot - 1] += count;
+}
+
+// -----------------------------------------------------------------------------
+static double histogram_edge(const histogram_t *const histogram,
+                             const size_t index) {
+  if (histogram->edges)
+    return histogram->edges[index];
+  return histogram->low + (double)index / histogram->scale;
+}
+
+// -----------------------------------------------------------------------------
+static size_t histogram_edge_slot(const histogram_t *const histogram,
+                                  const double value) {
+  // Narrow to the last edge at or below the value, then count it if it is.
+  const double *base = histogram->edges;
+  size_t count = histogram->bins + 1;
+  while (count > 1) {
+    const size_t half = count / 2;
+    base = base[half] <= value ? base + half : base;
+    count -= half;
+  }
+  return (size_t)(base - histogram->edges) + (*base <= value);
+}
+
+#if defined(HOST_SSE2)
+// -----------------------------------------------------------------------------
+static __m128i histogram_slots_sse2(const histogram_t *const histogram,
+                                    const __m128d values) {
+  const __m128d low = _mm_set1_pd(histogram->low);
+  const __m128d scale = _mm_set1_pd(histogram->scale);
+  const __m128d top = _mm_set1_pd((double)(histogram->bins + 1));
+  __m128d slot =
+      _mm_add_pd(_mm_mul_pd(_mm_sub_pd(values, low), scale), _mm_set1_pd(1));
+  // max returns its second operand for a NaN, so NaNs land below too.
+  slot = _mm_min_pd(_mm_max_pd(slot, _mm_setzero_pd()), top);
+  return _mm_cvttpd_epi32(slot);
+}
+#endif
+
+// -----------------------------------------------------------------------------
+static void run_parallel(void *(*work)(void *), void *const parts,
+                         const size_t part_size, const unsigned int count) {
+  unsigned char *const first = parts;
+#if defined(HOST)
+  pthread_t workers[MAX_THREADS];
+  unsigned char started[MAX_THREADS] = {0};
+  for (unsigned int t = 1; t < count; t++)
+    started[t] =
+        pthread_create(&workers[t], NULL, work, first + t * part_size) == 0;
+  work(first);
+  for (unsigned int t = 1; t < count; t++) {
+    if (started[t])
+      pthread_join(workers[t], NULL);
+    else
+      work(first + t * part_size);
+  }
+#else
+  for (unsigned int t = 0; t < count; t++)
+    work(first + t * part_size);
+#endif
+}
+
+// -----------------------------------------------------------------------------
+static void *accumulate_partial(void *arg) {
+  partial_stats_t *const part = arg;
+  for (size_t i = 0; i < HISTOGRAM_BINS; i++)
+    part->histogram[i] = 0;
+  for (size_t i = 0; i < part->len; i++)
+    part->histogram[part->arr[i]]++;
+  // The sum follows from the histogram, sparing an add per sample.
+  uint64_t sum = 0;
+  for (size_t value = 1; value < HISTOGRAM_BINS; value++)
+    sum += (uint64_t)part->histogram[value] * value;
+  part->sum = sum;
+  return NULL;
+}
+
+// -----------------------------------------------------------------------------
+static void accumulate(const unsigned char *const arr, const size_t len,
+                       partial_stats_t *const total) {
+  total->arr = arr;
+  total->len = len;
+#if defined(HOST)
+  const size_t threads = get_thread_count();
+  if (len < PARALLEL_MIN_LEN || threads < 2) {
+    accumulate_partial(total);
+    return;
+  }
+
+  partial_stats_t parts[MAX_THREADS];
+  const size_t slice = len / threads;
+  for (size_t t = 0; t < threads; t++) {
+    parts[t].arr = arr + t * slice;
+    parts[t].len = t == threads - 1 ? len - t * slice : slice;
+  }
+  run_parallel(accumulate_partial, parts, sizeof(parts[0]), threads);
+
+  *total = parts[0];
+  total->arr = arr;
+  total->len = len;
+  for (size_t t = 1; t < threads; t++) {
+    total->sum += parts[t].sum;
+    for (size_t i = 0; i < HISTOGRAM_BINS; i++)
+      total->histogram[i] += parts[t].histogram[i];
+  }
+#else
+  accumulate_partial(total);
+#endif
+}
+
+// -----------------------------------------------------------------------------
+static unsigned char histogram_value_at(const size_t *const histogram,
+                                        const size_t index) {
+  size_t seen = 0;
+  for (int value = HISTOGRAM_BINS - 1; value > 0; value--) {
+    seen += histogram[value];
+    if (seen > index)
+      return (unsigned char)value;
+  }
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+static group_stats_t *group_entry(group_table_t *const table,
+                                  const uint32_t key) {
+  if (key < GROUP_DENSE_KEYS)
+    return &table->dense[key];
+
+  size_t slot =
+      (uint32_t)(key * GROUP_HASH_MULTIPLIER) >> (32 - GROUP_HASH_BITS);
+  for (size_t probe = 0; probe < GROUP_HASH_SLOTS; probe++) {
+    group_stats_t *const entry = &table->slots[slot];
+    if (entry->count == 0 || entry->key == key)
+      return entry;
+    slot = (slot + 1) & (GROUP_HASH_SLOTS - 1);
+  }
+  return NULL;
+}
+
+// -----------------------------------------------------------------------------
+static void group_fold(group_table_t *const table,
+                       const group_stats_t *const src) {
+  group_stats_t *const entry = group_entry(table, src->key);
+  if (entry == NULL) {
+    table->dropped += src->count;
+    return;
+  }
+  if (entry->count == 0) {
+    *entry = *src;
+    if (src->key >= GROUP_DENSE_KEYS)
+      table->hashed++;
+    return;
+  }
+  entry->count += src->count;
+  entry->sum += src->sum;
+  if (src->minimum < entry->minimum)
+    entry->minimum = src->minimum;
+  if (src->maximum > entry->maximum)
+    entry->maximum = src->maximum;
+}
+
+// -----------------------------------------------------------------------------
+static void *group_update_partial(void *arg) {
+  group_part_t *const part = arg;
+  group_table_t *const table = part->table;
+  for (size_t i = 0; i < part->len; i++) {
+    const uint32_t key = part->samples[i].key;
+    const int32_t value = part->samples[i].value;
+    group_stats_t *const entry = group_entry(table, key);
+    if (entry == NULL) {
+      table->dropped++;
+    } else if (entry->count == 0) {
+      entry->count = 1;
+      entry->sum = value;
+      entry->key = key;
+      entry->minimum = value;
+      entry->maximum = value;
+      if (key >= GROUP_DENSE_KEYS)
+        table->hashed++;
+    } else {
+      entry->count++;
+      entry->sum += value;
+      if (value < entry->minimum)
+        entry->minimum = value;
+      if (value > entry->maximum)
+        entry->maximum = value;
+    }
+  }
+  return NULL;
 }
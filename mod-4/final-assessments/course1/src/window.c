@@ -0,0 +1,291 @@
+/******************************************************************************
+ * Copyright (C) 2025 by Michael Torres
+ *
+ * Redistribution, modification or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Michael Torres is not liable for any misuse of this material.
+ *
+ *****************************************************************************/
+/**
+ * @file window.c
+ * @brief Statistics over the last samples of a stream.
+ *
+ * @author Michael Torres
+ * @date 10/18/26
+ *
+ */
+#include "window.h"
+#include "stats.h"
+
+/* The heap of the lower half of the samples, largest on top. */
+#define LOWER (0)
+/* The heap of the upper half of the samples, smallest on top. */
+#define UPPER (1)
+
+/**
+ * @brief Find the index of a position in a deque's ring.
+ *
+ * @param window A read-only pointer to the window.
+ * @param deque A read-only pointer to the deque.
+ * @param offset How far the position is from the front of the deque.
+ *
+ * @return The index into the deque's slots.
+ */
+static unsigned int deque_index(const window_t *const window,
+                                const window_deque_t *const deque,
+                                const unsigned int offset);
+
+/**
+ * @brief Add a slot to the back of a monotonic deque.
+ *
+ * Slots at the back whose samples would never again be the deque's extreme
+ * are dropped first.
+ *
+ * @param window A pointer to the window.
+ * @param deque A pointer to the deque.
+ * @param slot The slot of the newest sample.
+ * @param keep_larger Non-zero for the maximum deque, zero for the minimum.
+ */
+static void deque_push(window_t *const window, window_deque_t *const deque,
+                       const unsigned int slot, const int keep_larger);
+
+/**
+ * @brief Say whether one slot belongs above another in a heap.
+ *
+ * @param window A read-only pointer to the window.
+ * @param side LOWER or UPPER.
+ * @param a The first slot.
+ * @param b The second slot.
+ *
+ * @return Non-zero if a belongs above b.
+ */
+static int heap_above(const window_t *const window, const unsigned int side,
+                      const unsigned int a, const unsigned int b);
+
+/**
+ * @brief Put a slot at a position in a heap and record where it is.
+ *
+ * @param window A pointer to the window.
+ * @param side LOWER or UPPER.
+ * @param position The position in the heap.
+ * @param slot The slot.
+ */
+static void heap_place(window_t *const window, const unsigned int side,
+                       const unsigned int position, const unsigned int slot);
+
+/**
+ * @brief Restore the heap order after the sample at a position changed.
+ *
+ * @param window A pointer to the window.
+ * @param side LOWER or UPPER.
+ * @param position The position of the changed sample.
+ */
+static void heap_fix(window_t *const window, const unsigned int side,
+                     unsigned int position);
+
+/**
+ * @brief Add a slot to a heap.
+ *
+ * @param window A pointer to the window.
+ * @param side LOWER or UPPER.
+ * @param slot The slot.
+ */
+static void heap_push(window_t *const window, const unsigned int side,
+                      const unsigned int slot);
+
+/**
+ * @brief Remove the top slot of a heap.
+ *
+ * @param window A pointer to the window.
+ * @param side LOWER or UPPER; the heap must not be empty.
+ *
+ * @return The slot that was on top.
+ */
+static unsigned int heap_pop(window_t *const window, const unsigned int side);
+
+/*******************************************************************************
+ Function Definitions
+*******************************************************************************/
+void window_init(window_t *const window, const unsigned int len) {
+  window->len = len;
+  window->count = 0;
+  window->next = 0;
+  window->sum = 0;
+  window->maximum.head = 0;
+  window->maximum.count = 0;
+  window->minimum.head = 0;
+  window->minimum.count = 0;
+  window->heap_count[LOWER] = 0;
+  window->heap_count[UPPER] = 0;
+}
+
+// -----------------------------------------------------------------------------
+void window_push(window_t *const window, const int32_t value) {
+  const unsigned int slot = window->next;
+  window->next = slot + 1 == window->len ? 0 : slot + 1;
+
+  if (window->count == window->len) {
+    // The oldest sample is at the front of a deque if it is in it at all.
+    window_deque_t *const deques[2] = {&window->maximum, &window->minimum};
+    for (unsigned int i = 0; i < 2; i++) {
+      if (deques[i]->count != 0 && deques[i]->slots[deques[i]->head] == slot) {
+        deques[i]->head =
+            deques[i]->head + 1 == window->len ? 0 : deques[i]->head + 1;
+        deques[i]->count--;
+      }
+    }
+    // The new sample takes the oldest one's place in its heap.
+    window->sum -= window->samples[slot];
+    window->samples[slot] = value;
+    heap_fix(window, window->side[slot], window->position[slot]);
+  } else {
+    window->samples[slot] = value;
+    window->count++;
+    if (window->heap_count[LOWER] == 0 ||
+        value <= window->samples[window->heap[LOWER][0]])
+      heap_push(window, LOWER, slot);
+    else
+      heap_push(window, UPPER, slot);
+    // The lower half holds the middle sample when the count is odd.
+    if (window->heap_count[LOWER] > window->heap_count[UPPER] + 1)
+      heap_push(window, UPPER, heap_pop(window, LOWER));
+    else if (window->heap_count[UPPER] > window->heap_count[LOWER])
+      heap_push(window, LOWER, heap_pop(window, UPPER));
+  }
+
+  // Only the new sample can be out of order between the halves.
+  if (window->heap_count[UPPER] != 0) {
+    const unsigned int lower = window->heap[LOWER][0];
+    const unsigned int upper = window->heap[UPPER][0];
+    if (window->samples[lower] > window->samples[upper]) {
+      heap_place(window, LOWER, 0, upper);
+      heap_place(window, UPPER, 0, lower);
+      heap_fix(window, LOWER, 0);
+      heap_fix(window, UPPER, 0);
+    }
+  }
+
+  window->sum += value;
+  deque_push(window, &window->maximum, slot, 1);
+  deque_push(window, &window->minimum, slot, 0);
+}
+
+// -----------------------------------------------------------------------------
+int32_t window_median(const window_t *const window) {
+  const int32_t lower = window->samples[window->heap[LOWER][0]];
+  if (window->count % 2 != 0)
+    return lower;
+  const int32_t upper = window->samples[window->heap[UPPER][0]];
+  return (int32_t)(((int64_t)lower + upper) / 2);
+}
+
+// -----------------------------------------------------------------------------
+int32_t window_mean(const window_t *const window) {
+  return (int32_t)(window->sum / window->count);
+}
+
+// -----------------------------------------------------------------------------
+int32_t window_maximum(const window_t *const window) {
+  return window->samples[window->maximum.slots[window->maximum.head]];
+}
+
+// -----------------------------------------------------------------------------
+int32_t window_minimum(const window_t *const window) {
+  return window->samples[window->minimum.slots[window->minimum.head]];
+}
+
+// -----------------------------------------------------------------------------
+void print_window(const window_t *const window) {
+  print_statistics_s32(window_median(window), window_mean(window),
+                       window_maximum(window), window_minimum(window));
+}
+
+// -----------------------------------------------------------------------------
+static unsigned int deque_index(const window_t *const window,
+                                const window_deque_t *const deque,
+                                const unsigned int offset) {
+  const unsigned int index = deque->head + offset;
+  return index >= window->len ? index - window->len : index;
+}
+
+// -----------------------------------------------------------------------------
+static void deque_push(window_t *const window, window_deque_t *const deque,
+                       const unsigned int slot, const int keep_larger) {
+  const int32_t value = window->samples[slot];
+  while (deque->count != 0) {
+    const int32_t back =
+        window->samples[deque->slots[deque_index(window, deque,
+                                                 deque->count - 1)]];
+    if (keep_larger ? back > value : back < value)
+      break;
+    deque->count--;
+  }
+  deque->slots[deque_index(window, deque, deque->count)] = slot;
+  deque->count++;
+}
+
+// -----------------------------------------------------------------------------
+static int heap_above(const window_t *const window, const unsigned int side,
+                      const unsigned int a, const unsigned int b) {
+  return side == LOWER ? window->samples[a] > window->samples[b]
+                       : window->samples[a] < window->samples[b];
+}
+
+// -----------------------------------------------------------------------------
+static void heap_place(window_t *const window, const unsigned int side,
+                       const unsigned int position, const unsigned int slot) {
+  window->heap[side][position] = slot;
+  window->side[slot] = side;
+  window->position[slot] = position;
+}
+
+// -----------------------------------------------------------------------------
+static void heap_fix(window_t *const window, const unsigned int side,
+                     unsigned int position) {
+  uint16_t *const heap = window->heap[side];
+  const unsigned int count = window->heap_count[side];
+  const unsigned int slot = heap[position];
+
+  // Sift up.
+  while (position > 0) {
+    const unsigned int parent = (position - 1) / 2;
+    if (!heap_above(window, side, slot, heap[parent]))
+      break;
+    heap_place(window, side, position, heap[parent]);
+    position = parent;
+  }
+  // Sift down.
+  for (;;) {
+    unsigned int child = 2 * position + 1;
+    if (child >= count)
+      break;
+    if (child + 1 < count && heap_above(window, side, heap[child + 1],
+                                        heap[child]))
+      child++;
+    if (!heap_above(window, side, heap[child], slot))
+      break;
+    heap_place(window, side, position, heap[child]);
+    position = child;
+  }
+  heap_place(window, side, position, slot);
+}
+
+// -----------------------------------------------------------------------------
+static void heap_push(window_t *const window, const unsigned int side,
+                      const unsigned int slot) {
+  const unsigned int position = window->heap_count[side]++;
+  heap_place(window, side, position, slot);
+  heap_fix(window, side, position);
+}
+
+// -----------------------------------------------------------------------------
+static unsigned int heap_pop(window_t *const window, const unsigned int side) {
+  const unsigned int top = window->heap[side][0];
+  const unsigned int last = --window->heap_count[side];
+  if (last != 0) {
+    heap_place(window, side, 0, window->heap[side][last]);
+    heap_fix(window, side, 0);
+  }
+  return top;
+}